@@ -0,0 +1,82 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include "Network.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Helpers shared by the benchmarks and tests: random data, a small sigmoid
+// MLP and timing
+
+namespace bench {
+
+// Fills t with values uniform in [-scale, scale]
+inline void randomize(nn::Tensor& t, std::mt19937& gen, float scale = 1.0f) {
+    std::uniform_real_distribution<float> dis(-scale, scale);
+    for (size_t i = 0; i < t.size(); ++i) {
+        t[i] = dis(gen);
+    }
+}
+
+inline nn::Tensor random_tensor(size_t rows, size_t cols, std::mt19937& gen, float scale = 1.0f) {
+    nn::Tensor t(rows, cols);
+    randomize(t, gen, scale);
+    return t;
+}
+
+// Linear layers of the given sizes, each followed by a sigmoid, which is
+// fused into the layer's epilogue when fuse_sigmoid is set. Weights are
+// Glorot-uniform so the sigmoids do not saturate.
+inline void build(nn::Network& net, const std::vector<size_t>& sizes, std::mt19937& gen,
+                  bool fuse_sigmoid = false) {
+    for (size_t i = 0; i + 1 < sizes.size(); ++i) {
+        auto* layer = new nn::Linear(sizes[i], sizes[i + 1],
+                                     fuse_sigmoid ? nn::Activation::Sigmoid : nn::Activation::Identity);
+        const float limit = std::sqrt(6.0f / (sizes[i] + sizes[i + 1]));
+        layer->set_weights(random_tensor(sizes[i + 1], sizes[i], gen, limit));
+        layer->set_bias(random_tensor(sizes[i + 1], 1, gen, 0.1f));
+        net.add_layer(layer);
+        if (!fuse_sigmoid) {
+            net.add_layer(new nn::Sigmoid());
+        }
+    }
+}
+
+inline float max_difference(const nn::Tensor& a, const nn::Tensor& b) {
+    float result = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i) {
+        result = std::max(result, std::fabs(a[i] - b[i]));
+    }
+    return result;
+}
+
+// Fastest of reps runs after a warm-up run, which is the least disturbed
+// by other load
+template <typename F>
+double time_ms(int reps, F&& f) {
+    f();
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// Duration of a single run, for work whose first call is what is measured
+template <typename F>
+double elapsed_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+} // namespace bench
+
+#endif // BENCH_UTIL_H
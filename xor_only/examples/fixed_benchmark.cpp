@@ -0,0 +1,67 @@
+#include "FixedLayer.h"
+#include "Network.h"
+#include <chrono>
+#include <iostream>
+
+// Compares single-sample inference latency of the 2-4-4-1 XOR model built
+// from dynamic Linear layers against the same weights in FixedLinear layers.
+
+namespace {
+
+template <typename F>
+double nanoseconds_per_call(F&& f, int repeats) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        f();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repeats;
+}
+
+} // namespace
+
+int main() {
+    auto* l1 = new nn::Linear(2, 4);
+    auto* l2 = new nn::Linear(4, 4);
+    auto* l3 = new nn::Linear(4, 1);
+    nn::Network net;
+    net.add_layer(l1);
+    net.add_layer(new nn::Sigmoid());
+    net.add_layer(l2);
+    net.add_layer(new nn::Sigmoid());
+    net.add_layer(l3);
+    net.add_layer(new nn::Sigmoid());
+
+    // Same parameters in the fixed-shape layers
+    nn::FixedLinear<2, 4> f1;
+    nn::FixedLinear<4, 4> f2;
+    nn::FixedLinear<4, 1> f3;
+    f1.set_weights(*l1->get_parameters()[0]);
+    f1.set_bias(*l1->get_parameters()[1]);
+    f2.set_weights(*l2->get_parameters()[0]);
+    f2.set_bias(*l2->get_parameters()[1]);
+    f3.set_weights(*l3->get_parameters()[0]);
+    f3.set_bias(*l3->get_parameters()[1]);
+
+    nn::Tensor x({0.0f, 1.0f}, {2, 1});
+    nn::FixedTensor<2, 1> xf(x);
+
+    auto fixed_forward = [&] {
+        return nn::sigmoid(f3.forward(nn::sigmoid(f2.forward(nn::sigmoid(f1.forward(xf))))));
+    };
+
+    const float dynamic_out = net.forward(x)[0];
+    const float fixed_out = fixed_forward()[0];
+    std::cout << "Outputs: dynamic " << dynamic_out << ", fixed " << fixed_out
+              << (dynamic_out == fixed_out ? " (identical)" : " (differ)") << std::endl;
+
+    const int repeats = 1000000;
+    volatile float sink = 0.0f;
+    double dynamic_ns = nanoseconds_per_call([&] { sink = net.forward(x)[0]; }, repeats);
+    double fixed_ns = nanoseconds_per_call([&] { sink = fixed_forward()[0]; }, repeats);
+
+    std::cout << "Network::forward:   " << dynamic_ns << " ns/sample" << std::endl;
+    std::cout << "FixedLinear chain:  " << fixed_ns << " ns/sample" << std::endl;
+    std::cout << "Speedup:            " << dynamic_ns / fixed_ns << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "FastMath.h"
+#include "Kernels.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Measures the accuracy and throughput of the vectorized transcendental
+// kernels against libm for each accuracy tier.
+
+namespace {
+
+using ArrayFn = std::function<void(const float*, float*, size_t)>;
+
+struct Function {
+    const char* name;
+    float lo;
+    float hi;
+    double (*reference)(double);
+    float (*libm)(float);
+    void (*kernel)(const float*, float*, size_t, nn::MathPrecision);
+};
+
+double sigmoid_ref(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+double exp_ref(double x) { return std::exp(x); }
+double log_ref(double x) { return std::log(x); }
+double tanh_ref(double x) { return std::tanh(x); }
+
+float sigmoid_libm(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+float exp_libm(float x) { return std::exp(x); }
+float log_libm(float x) { return std::log(x); }
+float tanh_libm(float x) { return std::tanh(x); }
+
+// Every float in [lo, hi] whose bit pattern is a multiple of the stride
+std::vector<float> sample_range(float lo, float hi, uint32_t stride) {
+    std::vector<float> values;
+    for (uint64_t bits = 0; bits <= 0xffffffffu; bits += stride) {
+        const uint32_t b = static_cast<uint32_t>(bits);
+        float x;
+        std::memcpy(&x, &b, sizeof(x));
+        if (x >= lo && x <= hi) {
+            values.push_back(x);
+        }
+    }
+    return values;
+}
+
+double max_relative_error(const Function& fn, const std::vector<float>& xs, nn::MathPrecision precision) {
+    std::vector<float> ys(xs.size());
+    fn.kernel(xs.data(), ys.data(), xs.size(), precision);
+
+    double worst = 0.0;
+    for (size_t i = 0; i < xs.size(); ++i) {
+        const double ref = fn.reference(xs[i]);
+        if (std::fabs(ref) < 1.17549435e-38 || std::isinf(ref)) {
+            continue;
+        }
+        worst = std::max(worst, std::fabs((ys[i] - ref) / ref));
+    }
+    return worst;
+}
+
+double throughput(const ArrayFn& fn, const std::vector<float>& xs) {
+    std::vector<float> ys(xs.size());
+    const int repeats = 50;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        fn(xs.data(), ys.data(), xs.size());
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return repeats * xs.size() / elapsed.count() / 1e6;
+}
+
+} // namespace
+
+int main() {
+    const Function functions[] = {
+        {"exp", -87.0f, 88.0f, exp_ref, exp_libm, nn::math::exp},
+        {"log", 1e-37f, 3e38f, log_ref, log_libm, nn::math::log},
+        {"sigmoid", -80.0f, 80.0f, sigmoid_ref, sigmoid_libm, nn::math::sigmoid},
+        {"tanh", -20.0f, 20.0f, tanh_ref, tanh_libm, nn::math::tanh},
+    };
+
+    std::cout << "Kernel ISA: " << nn::kernels::isa_name(nn::kernels::active_isa()) << std::endl;
+    std::cout << std::left << std::setw(10) << "function"
+              << std::setw(22) << "range"
+              << std::setw(14) << "err accurate" << std::setw(14) << "err fast"
+              << std::setw(14) << "libm Mel/s" << std::setw(16) << "accurate Mel/s"
+              << "fast Mel/s" << std::endl;
+
+    for (const Function& fn : functions) {
+        const std::vector<float> xs = sample_range(fn.lo, fn.hi, 61);
+
+        // Throughput is measured on an L2-sized slice of the samples
+        std::vector<float> batch;
+        for (size_t i = 0; i < xs.size() && batch.size() < 16384; i += xs.size() / 16384 + 1) {
+            batch.push_back(xs[i]);
+        }
+
+        auto libm = [&fn](const float* in, float* out, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = fn.libm(in[i]);
+            }
+        };
+        auto tier = [&fn](nn::MathPrecision precision) {
+            return [&fn, precision](const float* in, float* out, size_t n) {
+                fn.kernel(in, out, n, precision);
+            };
+        };
+
+        std::ostringstream range;
+        range << "[" << fn.lo << ", " << fn.hi << "]";
+        std::cout << std::setw(10) << fn.name << std::setw(22) << range.str()
+                  << std::setw(14) << std::setprecision(2) << std::scientific
+                  << max_relative_error(fn, xs, nn::MathPrecision::Accurate)
+                  << std::setw(14) << max_relative_error(fn, xs, nn::MathPrecision::Fast)
+                  << std::fixed << std::setprecision(0)
+                  << std::setw(14) << throughput(libm, batch)
+                  << std::setw(16) << throughput(tier(nn::MathPrecision::Accurate), batch)
+                  << throughput(tier(nn::MathPrecision::Fast), batch)
+                  << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+
+    return 0;
+}
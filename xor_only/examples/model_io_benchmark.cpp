@@ -0,0 +1,52 @@
+#include "BenchUtil.h"
+#include "Network.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+// Saves a 4 x 2048 wide MLP, then compares reading the whole file into
+// memory, as a copying loader must, with Network::load mapping it. The
+// mapped load only parses the records; weights are paged in by the first
+// forward pass, whose output must match the original network exactly.
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "model_io_benchmark.nnm";
+    const size_t width = 2048;
+    const size_t depth = 4;
+    std::mt19937 gen(42);
+
+    nn::Network original;
+    bench::build(original, std::vector<size_t>(depth + 1, width), gen);
+    const nn::Tensor input = bench::random_tensor(width, 8, gen);
+    const nn::Tensor expected = original.forward(input);
+
+    const double save_ms = bench::elapsed_ms([&] { original.save(path); });
+
+    std::vector<char> bytes;
+    const double read_ms = bench::elapsed_ms([&] {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        bytes.resize(static_cast<size_t>(in.tellg()));
+        in.seekg(0);
+        in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    });
+
+    nn::Network loaded;
+    const double load_ms = bench::elapsed_ms([&] { loaded.load(path); });
+    nn::Tensor output;
+    const double first_ms = bench::elapsed_ms([&] { output = loaded.forward(input); });
+    const double second_ms = bench::elapsed_ms([&] { output = loaded.forward(input); });
+
+    const bool exact = output.shape() == expected.shape() &&
+                       std::memcmp(output.data(), expected.data(), output.size() * sizeof(float)) == 0;
+    std::printf("%zu layers of %zux%zu, %.1f MB file\n", depth, width, width, bytes.size() / 1048576.0);
+    std::printf("save                %8.2f ms\n", save_ms);
+    std::printf("read into memory    %8.2f ms\n", read_ms);
+    std::printf("mapped load         %8.3f ms\n", load_ms);
+    std::printf("first forward       %8.2f ms\n", first_ms);
+    std::printf("second forward      %8.2f ms\n", second_ms);
+    std::printf("output matches      %8s\n", exact ? "yes" : "no");
+    std::remove(path);
+    return exact ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+#include "BenchUtil.h"
+#include "Trainer.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+
+// Trains the same student MLP toward a fixed teacher with each optimizer,
+// from identical initial weights, and reports the loss after a number of
+// epochs and how many epochs each needs to reach a target loss. Also times
+// one parameter update of a large layer: the per-layer update against the
+// optimizers' single fused pass.
+
+namespace {
+
+struct Candidate {
+    const char* name;
+    float learning_rate;
+    std::unique_ptr<nn::Optimizer> (*make)();
+};
+
+} // namespace
+
+int main() {
+    std::mt19937 gen(42);
+    const std::vector<size_t> sizes = {32, 128, 128, 8};
+    const size_t samples = 2048;
+    const int epochs = 30;
+    const float target_loss = 2e-5f;
+
+    nn::Network teacher;
+    bench::build(teacher, sizes, gen, true);
+    gen.discard(1000);
+    nn::Tensor inputs = bench::random_tensor(sizes.front(), samples, gen, 1.0f);
+    nn::Tensor targets = teacher.forward(inputs);
+    // Every student starts from the weights of the same generator state
+    auto build_student = [](nn::Network& net, const std::vector<size_t>& layer_sizes) {
+        std::mt19937 student_gen(7);
+        bench::build(net, layer_sizes, student_gen, true);
+    };
+
+    const Candidate candidates[] = {
+        {"sgd", 2.0f, [] { return std::unique_ptr<nn::Optimizer>(); }},
+        {"momentum", 0.5f, [] { return std::unique_ptr<nn::Optimizer>(new nn::SGD(0.9f)); }},
+        {"nesterov", 0.5f, [] { return std::unique_ptr<nn::Optimizer>(new nn::SGD(0.9f, true)); }},
+        {"adam", 0.002f, [] { return std::unique_ptr<nn::Optimizer>(new nn::Adam()); }},
+        {"adamw", 0.002f, [] { return std::unique_ptr<nn::Optimizer>(new nn::AdamW(0.9f, 0.999f, 1e-8f, 1e-4f)); }},
+    };
+    std::printf("mlp 32-128-128-8, %zu samples, batch 32, %d epochs\n", samples, epochs);
+    for (const auto& candidate : candidates) {
+        nn::Network student;
+        build_student(student, sizes);
+        student.set_optimizer(candidate.make());
+        nn::Trainer trainer(student, 32);
+        trainer.set_shuffle(true);
+        nn::MSELoss loss;
+        int reached = -1;
+        float last = 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (int e = 0; e < epochs; ++e) {
+            last = trainer.train_epoch(inputs, targets, loss, candidate.learning_rate);
+            if (reached < 0 && last <= target_loss) {
+                reached = e + 1;
+            }
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        char epochs_text[16];
+        std::snprintf(epochs_text, sizeof(epochs_text), reached < 0 ? "-" : "%d", reached);
+        std::printf("  %-9s lr %-6g  loss %.3g  epochs to %.0e: %-3s  epoch %.2f ms\n", candidate.name,
+                    candidate.learning_rate, last, target_loss, epochs_text, elapsed.count() / epochs);
+    }
+
+    // Update cost alone, with the gradients left in place by one step
+    const size_t width = 2048;
+    std::printf("update of a %zux%zu layer\n", width, width);
+    for (const auto& candidate : candidates) {
+        nn::Network net;
+        build_student(net, {width, width});
+        net.set_optimizer(candidate.make());
+        nn::Tensor x = bench::random_tensor(width, 4, gen, 1.0f);
+        nn::Tensor t = bench::random_tensor(width, 4, gen, 0.5f);
+        net.train_step(x, t, 0.0f);
+        auto& layers = net.get_layers();
+        const double ms = bench::time_ms(10, [&] {
+            if (net.get_optimizer()) {
+                net.get_optimizer()->step(layers, 1e-6f);
+            } else {
+                layers[0]->update_parameters(1e-6f);
+            }
+        });
+        std::printf("  %-9s %.3f ms\n", candidate.name, ms);
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "Network.h"
+#include "Scheduler.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+// Trains a wide MLP on random data and reports the step time and how busy
+// each scheduler slot was, to expose load imbalance between workers.
+
+int main() {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+
+    nn::Network net;
+    net.add_layer(new nn::Linear(1024, 1024));
+    net.add_layer(new nn::Sigmoid());
+    net.add_layer(new nn::Linear(1024, 1024));
+    net.add_layer(new nn::Sigmoid());
+    net.add_layer(new nn::Linear(1024, 10));
+    net.add_layer(new nn::Sigmoid());
+
+    const size_t batch = 256;
+    nn::Tensor input(1024, batch);
+    nn::Tensor target(10, batch);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = dis(gen);
+    }
+    for (size_t i = 0; i < target.size(); ++i) {
+        target[i] = dis(gen);
+    }
+
+    // Warm up buffers and worker threads
+    net.train_step(input, target, 0.01f);
+
+    const int steps = 10;
+    nn::scheduler().reset_stats();
+    auto start = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; ++s) {
+        net.train_step(input, target, 0.01f);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("threads: %zu\n", nn::num_threads());
+    std::printf("train step: %.2f ms\n", elapsed.count() / steps);
+    const auto stats = nn::scheduler().stats();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        std::printf("slot %zu: %6llu tasks, %6llu stolen, %5.1f%% busy\n", i,
+                    static_cast<unsigned long long>(stats[i].tasks_run),
+                    static_cast<unsigned long long>(stats[i].tasks_stolen),
+                    100.0 * stats[i].utilization());
+    }
+    return 0;
+}
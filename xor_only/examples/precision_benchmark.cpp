@@ -0,0 +1,101 @@
+#include "BenchUtil.h"
+#include "Network.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+// Compares float32 storage with bfloat16 and float16: GEMM time and error
+// against float32, then a student MLP trained toward a fixed teacher from
+// identical initial weights in each storage type.
+
+namespace {
+
+const nn::DType TYPES[] = {nn::DType::Float32, nn::DType::BFloat16, nn::DType::Float16};
+
+// Copies the float32 parameters of one network into another
+void copy_parameters(nn::Network& from, nn::Network& to) {
+    for (size_t i = 0; i < from.get_layers().size(); ++i) {
+        auto* source = dynamic_cast<nn::Linear*>(from.get_layers()[i]);
+        auto* dest = dynamic_cast<nn::Linear*>(to.get_layers()[i]);
+        if (source && dest) {
+            dest->set_weights(source->get_parameters()[0]->to(nn::DType::Float32));
+            dest->set_bias(*source->get_parameters()[1]);
+        }
+    }
+}
+
+size_t parameter_bytes(nn::Network& net) {
+    size_t bytes = 0;
+    for (auto* layer : net.get_layers()) {
+        for (auto* param : layer->get_parameters()) {
+            bytes += param->size() * nn::dtype_size(param->dtype());
+        }
+    }
+    return bytes;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 gen(42);
+
+    // GEMM: weights in the storage type, activations in float32
+    const size_t n = 1024;
+    nn::Tensor a = bench::random_tensor(n, n, gen, 1.0f);
+    nn::Tensor b = bench::random_tensor(n, n, gen, 1.0f);
+    nn::Tensor reference = a.matmul(b);
+    std::printf("gemm %zux%zux%zu\n", n, n, n);
+    for (nn::DType dtype : TYPES) {
+        nn::Tensor narrow_a = a.to(dtype);
+        nn::Tensor c;
+        nn::matmul_into(c, narrow_a, b);
+        const int reps = 5;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            nn::matmul_into(c, narrow_a, b);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::printf("  %-9s %8.2f ms  max error %.3g\n", nn::dtype_name(dtype), elapsed.count() / reps,
+                    bench::max_difference(c, reference));
+    }
+
+    // Teacher-student regression
+    const std::vector<size_t> sizes = {64, 256, 256, 16};
+    const size_t batch = 128;
+    nn::Network teacher;
+    bench::build(teacher, sizes, gen);
+    nn::Tensor input = bench::random_tensor(sizes.front(), batch, gen, 1.0f);
+    nn::Tensor target = teacher.forward(input);
+
+    nn::Network initial;
+    bench::build(initial, sizes, gen);
+    nn::Tensor initial_error = initial.forward(input) - target;
+
+    const int steps = 300;
+    nn::Tensor baseline;
+    std::printf("teacher-student %zu steps, initial loss %.4g\n", static_cast<size_t>(steps),
+                nn::Tensor(initial_error * initial_error).mean()[0]);
+    for (nn::DType dtype : TYPES) {
+        nn::Network student;
+        bench::build(student, sizes, gen);
+        copy_parameters(initial, student);
+        student.set_storage_type(dtype);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < steps; ++s) {
+            student.train_step(input, target, 1.28f);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        nn::Tensor output = student.forward(input);
+        nn::Tensor error = output - target;
+        const float loss = nn::Tensor(error * error).mean()[0];
+        if (dtype == nn::DType::Float32) {
+            baseline = output;
+        }
+        std::printf("  %-9s loss %.4g  max output diff %.3g  parameters %zu bytes  step %.2f ms\n",
+                    nn::dtype_name(dtype), loss, bench::max_difference(output, baseline), parameter_bytes(student),
+                    elapsed.count() / steps);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include "BenchUtil.h"
+#include "Network.h"
+#include "Quantize.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Compares int8 inference with float32: the Linear product on its own, then
+// a trained MLP's outputs on held-out data before and after quantization.
+
+namespace {
+
+float mean_squared(const nn::Tensor& a, const nn::Tensor& b) {
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    return static_cast<float>(sum / a.size());
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 gen(42);
+
+    // One layer's product: 1024 x 1024 weights, batch of 256
+    nn::Tensor weights = bench::random_tensor(1024, 1024, gen, 0.1f);
+    nn::Tensor bias = bench::random_tensor(1024, 1, gen, 0.1f);
+    nn::Tensor input = bench::random_tensor(1024, 256, gen, 1.0f);
+    nn::QuantizedMatrix quantized(weights);
+    const nn::ActivationQuantization input_range = nn::ActivationQuantization::calibrate(input);
+
+    nn::Tensor reference, result;
+    const double fp32_ms = bench::time_ms(5, [&] { nn::matmul_into(reference, weights, input); });
+    const double int8_ms = bench::time_ms(5, [&] { nn::quantized_linear_into(result, quantized, input, input_range, bias); });
+    for (size_t i = 0; i < reference.rows(); ++i) {
+        for (size_t j = 0; j < reference.cols(); ++j) {
+            reference(i, j) += bias[i];
+        }
+    }
+    std::printf("linear 1024x1024, batch 256\n");
+    std::printf("  float32 %8.2f ms  weights %zu bytes\n", fp32_ms, weights.size() * sizeof(float));
+    std::printf("  int8    %8.2f ms  weights %zu bytes  max error %.3g\n", int8_ms, quantized.bytes(),
+                bench::max_difference(result, reference));
+
+    // Teacher-student regression: train in float32, then quantize with a
+    // calibration sample and evaluate on held-out inputs
+    const std::vector<size_t> sizes = {64, 256, 256, 16};
+    nn::Network teacher;
+    bench::build(teacher, sizes, gen);
+    nn::Tensor train_input = bench::random_tensor(sizes.front(), 256, gen, 1.0f);
+    nn::Tensor test_input = bench::random_tensor(sizes.front(), 256, gen, 1.0f);
+    nn::Tensor train_target = teacher.forward(train_input);
+    nn::Tensor test_target = teacher.forward(test_input);
+
+    nn::Network student;
+    bench::build(student, sizes, gen);
+    for (int s = 0; s < 300; ++s) {
+        student.train_step(train_input, train_target, 2.56f);
+    }
+    nn::Tensor fp32_output = student.forward(test_input);
+    const double fp32_forward = bench::time_ms(20, [&] { student.forward(test_input); });
+
+    student.quantize(train_input);
+    nn::Tensor int8_output = student.forward(test_input);
+    const double int8_forward = bench::time_ms(20, [&] { student.forward(test_input); });
+
+    std::printf("mlp 64-256-256-16, 256 held-out inputs\n");
+    std::printf("  float32 test mse %.3g  forward %.3f ms\n", mean_squared(fp32_output, test_target), fp32_forward);
+    std::printf("  int8    test mse %.3g  forward %.3f ms\n", mean_squared(int8_output, test_target), int8_forward);
+    std::printf("  output delta: max %.3g, rms %.3g\n", bench::max_difference(int8_output, fp32_output),
+                std::sqrt(mean_squared(int8_output, fp32_output)));
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "BenchUtil.h"
+#include "Network.h"
+#include "Sparse.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+// Multiplies a pruned 1024 x 1024 weight matrix by a batch of inputs at
+// increasing sparsity, densely and in both sparse formats, to show the
+// sparse time following the number of stored weights.
+
+namespace {
+
+bool same_bits(const nn::Tensor& a, const nn::Tensor& b) {
+    return std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 gen(42);
+    const size_t n = 1024;
+    const size_t batch = 64;
+    const nn::Tensor weights = bench::random_tensor(n, n, gen);
+    const nn::Tensor input = bench::random_tensor(n, batch, gen);
+
+    std::printf("1024x1024 weights, batch %zu\n", batch);
+    std::printf("sparsity   dense ms     csr ms (stored)   blocked ms (stored)   exact\n");
+    for (float sparsity : {0.0f, 0.5f, 0.8f, 0.9f, 0.95f, 0.99f}) {
+        nn::Tensor unstructured = weights;
+        nn::Tensor blocked = weights;
+        nn::magnitude_prune({&unstructured}, sparsity);
+        nn::magnitude_prune({&blocked}, sparsity, 4);
+        const nn::SparseMatrix csr(unstructured, nn::SparseFormat::CSR);
+        const nn::SparseMatrix bsr(blocked, nn::SparseFormat::Blocked);
+
+        nn::Tensor dense_out, dense_blocked_out, csr_out, bsr_out;
+        const double dense_ms = bench::time_ms(5, [&] { nn::matmul_into(dense_out, unstructured, input); });
+        const double csr_ms = bench::time_ms(5, [&] { nn::sparse_matmul_into(csr_out, csr, input); });
+        const double bsr_ms = bench::time_ms(5, [&] { nn::sparse_matmul_into(bsr_out, bsr, input); });
+        nn::matmul_into(dense_blocked_out, blocked, input);
+
+        std::printf("%7.0f%%  %9.2f  %9.2f (%7zu)  %9.2f (%7zu)      %s\n", 100.0f * sparsity, dense_ms, csr_ms,
+                    csr.stored(), bsr_ms, bsr.stored(),
+                    same_bits(dense_out, csr_out) && same_bits(dense_blocked_out, bsr_out) ? "yes" : "no");
+    }
+    return 0;
+}
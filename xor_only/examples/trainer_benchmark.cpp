@@ -0,0 +1,80 @@
+#include "BenchUtil.h"
+#include "Trainer.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+// Trains a student MLP toward a fixed teacher with one train_step per
+// sample, then with the mini-batch Trainer at increasing batch sizes, all
+// from the same initial weights. Reports the time per epoch and the loss
+// on the training set after a fixed number of epochs.
+
+namespace {
+
+float mean_squared(nn::Network& net, const nn::Tensor& input, const nn::Tensor& target) {
+    nn::Tensor error = net.forward(input) - target;
+    return nn::Tensor(error * error).mean()[0];
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 gen(42);
+    const std::vector<size_t> sizes = {32, 128, 128, 8};
+    const size_t samples = 2048;
+    const int epochs = 5;
+    const float learning_rate = 0.5f;
+
+    nn::Network teacher;
+    bench::build(teacher, sizes, gen, true);
+    gen.discard(1000);
+    nn::Tensor inputs = bench::random_tensor(sizes.front(), samples, gen, 1.0f);
+    nn::Tensor targets = teacher.forward(inputs);
+
+    // Every student starts from the weights of the same generator state
+    auto build_student = [](nn::Network& net, const std::vector<size_t>& layer_sizes) {
+        std::mt19937 student_gen(7);
+        bench::build(net, layer_sizes, student_gen, true);
+    };
+    {
+        nn::Network initial;
+        build_student(initial, sizes);
+        std::printf("mlp 32-128-128-8, %zu samples, %d epochs, learning rate %.2g, initial loss %.4g\n",
+                    samples, epochs, learning_rate, mean_squared(initial, inputs, targets));
+    }
+
+    // One train_step per sample, reading each column as its own tensor
+    {
+        nn::Network student;
+        build_student(student, sizes);
+        std::vector<nn::Tensor> x, t;
+        for (size_t j = 0; j < samples; ++j) {
+            x.push_back(inputs.slice(1, j, j + 1).contiguous());
+            t.push_back(targets.slice(1, j, j + 1).contiguous());
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int e = 0; e < epochs; ++e) {
+            for (size_t j = 0; j < samples; ++j) {
+                student.train_step(x[j], t[j], learning_rate);
+            }
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::printf("  per-sample    epoch %8.2f ms  loss %.4g\n", elapsed.count() / epochs,
+                    mean_squared(student, inputs, targets));
+    }
+
+    for (size_t batch : {8, 32, 128}) {
+        nn::Network student;
+        build_student(student, sizes);
+        nn::Trainer trainer(student, batch);
+        trainer.set_shuffle(true);
+        auto start = std::chrono::steady_clock::now();
+        for (int e = 0; e < epochs; ++e) {
+            trainer.train_epoch(inputs, targets, learning_rate);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::printf("  batch %-6zu  epoch %8.2f ms  loss %.4g\n", batch, elapsed.count() / epochs,
+                    mean_squared(student, inputs, targets));
+    }
+    return 0;
+}
@@ -19,6 +19,10 @@ int main() {
     net.add_layer(new nn::Linear(4, 1));
     net.add_layer(new nn::Sigmoid());  // Final activation
     
+    // Fold each Sigmoid into the Linear layer before it, so it is applied
+    // in the matmul epilogue instead of as a separate layer
+    net.compile();
+    
     // Prepare XOR training data
     std::vector<nn::Tensor> train_data = {
         nn::Tensor({{0.0f, 0.0f}}, {2, 1}),
@@ -46,12 +50,9 @@ int main() {
         float total_loss = 0.0f;
         
         for (size_t i = 0; i < train_data.size(); ++i) {
-            nn::Tensor output = net.forward(train_data[i]);
-            float loss = loss_fn.compute(output, train_targets[i]);
-            total_loss += loss;
-            
-            // Simple gradient descent step
-            net.train_step(train_data[i], train_targets[i], learning_rate);
+            // Simple gradient descent step, which also returns the loss of
+            // its forward pass
+            total_loss += net.train_step(train_data[i], train_targets[i], loss_fn, learning_rate);
         }
         
         if (epoch % 1000 == 0) {
@@ -0,0 +1,99 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <unordered_set>
+
+namespace nn {
+
+struct AllocatorStats {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes_in_use = 0;
+    size_t peak_bytes_in_use = 0;
+    size_t huge_page_allocations = 0;  // Allocations backed by huge pages
+};
+
+// Interface for the memory behind Tensor storage. Allocators installed with
+// set_default_allocator must be thread-safe.
+class Allocator {
+public:
+    virtual ~Allocator() = default;
+    virtual void* allocate(size_t bytes) = 0;
+    virtual void deallocate(void* ptr, size_t bytes) = 0;
+    virtual AllocatorStats stats() const = 0;
+
+    // True when buffers may be released in bulk before their owners are
+    // destroyed (see Arena); such buffers are never shared with longer-lived
+    // storage
+    virtual bool transient() const { return false; }
+};
+
+enum class HugePageMode {
+    Off,
+    Advise,   // Transparent huge pages via madvise(MADV_HUGEPAGE)
+    Explicit  // Reserved huge pages via mmap(MAP_HUGETLB), falling back to Advise
+};
+
+// Aligned heap allocator, 64 bytes by default so every buffer starts on a
+// cache line and suits aligned vector loads. Buffers of at least
+// huge_page_threshold bytes can be backed by 2 MiB huge pages to cut TLB
+// misses on large weight matrices (Linux only; elsewhere ignored).
+class AlignedAllocator : public Allocator {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+
+    explicit AlignedAllocator(size_t alignment = 64,
+                              HugePageMode huge_pages = HugePageMode::Off,
+                              size_t huge_page_threshold = HUGE_PAGE_SIZE);
+    ~AlignedAllocator() override = default;
+
+    void* allocate(size_t bytes) override;
+    void deallocate(void* ptr, size_t bytes) override;
+    AllocatorStats stats() const override;
+
+    void set_huge_page_mode(HugePageMode mode, size_t threshold = HUGE_PAGE_SIZE);
+    HugePageMode huge_page_mode() const { return huge_pages_.load(); }
+    size_t alignment() const { return alignment_; }
+
+private:
+    void* allocate_huge(size_t bytes, HugePageMode mode, bool& huge);
+
+    const size_t alignment_;
+    std::atomic<HugePageMode> huge_pages_;
+    std::atomic<size_t> huge_page_threshold_;
+
+    std::atomic<size_t> allocations_{0};
+    std::atomic<size_t> deallocations_{0};
+    std::atomic<size_t> bytes_in_use_{0};
+    std::atomic<size_t> peak_bytes_in_use_{0};
+    std::atomic<size_t> huge_page_allocations_{0};
+
+    // Blocks that must go back through munmap or the huge-page alignment
+    std::atomic<size_t> large_blocks_{0};
+    std::mutex large_mutex_;
+    std::unordered_set<void*> mapped_blocks_;
+    std::unordered_set<void*> huge_aligned_blocks_;
+};
+
+// The 64-byte aligned allocator used unless another one is installed
+AlignedAllocator& builtin_allocator();
+
+// Allocator for newly created tensors. Existing tensors keep the allocator
+// they were created with. Passing nullptr restores builtin_allocator().
+Allocator* default_allocator();
+void set_default_allocator(Allocator* allocator);
+
+// Allocator for tensors created on the calling thread: the arena of the
+// innermost ArenaScope (see Arena.h), otherwise default_allocator()
+Allocator* current_allocator();
+
+// Sets the calling thread's allocator override (nullptr clears it) and
+// returns the previous one; used by ArenaScope
+Allocator* exchange_thread_allocator(Allocator* allocator);
+
+} // namespace nn
+
+#endif // ALLOCATOR_H
@@ -0,0 +1,72 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "Allocator.h"
+#include <vector>
+
+namespace nn {
+
+// Bump-pointer allocator for tensors that share one lifetime, such as the
+// temporaries of a training step. deallocate is a no-op; reset() releases
+// everything at once in O(1) and keeps the chunks for the next step.
+// An Arena is not thread-safe; each thread uses its own via thread_arena().
+class Arena : public Allocator {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    explicit Arena(size_t chunk_size = size_t(1) << 20, Allocator* upstream = nullptr);
+    ~Arena() override;
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes) override;
+    void deallocate(void* ptr, size_t bytes) override;
+    AllocatorStats stats() const override;
+    bool transient() const override { return true; }
+
+    void reset();
+    size_t capacity() const;  // Bytes reserved from the upstream allocator
+
+private:
+    friend class ArenaScope;
+
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    size_t chunk_size_;
+    Allocator* upstream_;
+    std::vector<Chunk> chunks_;
+    size_t current_ = 0;  // Chunk being bumped
+    size_t offset_ = 0;   // Bytes used in the current chunk
+    int scope_depth_ = 0;
+    AllocatorStats stats_;
+};
+
+// Arena owned by the calling thread
+Arena& thread_arena();
+
+// Makes an arena the allocator for every tensor created on this thread
+// while the scope is alive. When the outermost scope of an arena ends, the
+// arena is reset, so tensors created inside must not outlive it. Assigning
+// such a tensor to one created outside copies the data instead of taking
+// over the arena buffer.
+class ArenaScope {
+public:
+    ArenaScope();  // Uses thread_arena()
+    explicit ArenaScope(Arena& arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena& arena_;
+    Allocator* previous_;
+};
+
+} // namespace nn
+
+#endif // ARENA_H
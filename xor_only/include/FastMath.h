@@ -0,0 +1,43 @@
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <cstddef>
+
+namespace nn {
+
+// Accuracy tiers for the vectorized transcendental functions. Maximum
+// relative error against double-precision libm, measured over every kernel
+// variant with examples/math_benchmark.cpp:
+//
+//              input range       Accurate   Fast
+//   exp        [-87, 88]         1.2e-7     6.0e-5
+//   log        [1e-37, 3e38]     8.0e-8     3.9e-6
+//   sigmoid    [-80, 80]         1.8e-7     5.9e-5
+//   tanh       [-20, 20]         1.4e-7     2.1e-5
+//
+// Accurate stays within about 1 ulp of libm. It flushes results that would
+// be subnormal to zero. Fast clamps exp inputs to [-87, 88.37], does not
+// handle subnormal log inputs and does not propagate NaN.
+//
+// Results depend on the instruction set: AVX2 and AVX-512 use fused
+// multiply-adds in both tiers, and every SIMD variant of Fast uses the
+// approximate reciprocal, so only Accurate on SSE2 matches the scalar
+// reference bit for bit (tests/math_test.cpp).
+enum class MathPrecision {
+    Accurate,
+    Fast
+};
+
+namespace math {
+
+// Element-wise out[i] = f(in[i]); out may alias in
+void exp(const float* in, float* out, size_t n, MathPrecision precision = MathPrecision::Accurate);
+void log(const float* in, float* out, size_t n, MathPrecision precision = MathPrecision::Accurate);
+void sigmoid(const float* in, float* out, size_t n, MathPrecision precision = MathPrecision::Accurate);
+void tanh(const float* in, float* out, size_t n, MathPrecision precision = MathPrecision::Accurate);
+
+} // namespace math
+
+} // namespace nn
+
+#endif // FAST_MATH_H
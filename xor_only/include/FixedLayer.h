@@ -0,0 +1,177 @@
+#ifndef FIXED_LAYER_H
+#define FIXED_LAYER_H
+
+#include "FixedTensor.h"
+#include "Layer.h"
+#include <random>
+
+namespace nn {
+
+// Fully connected layer with compile-time sizes and parameters stored
+// inline. The typed forward on FixedTensors is a non-virtual, allocation-free
+// path with unrolled loops for latency-critical inference. The class is also
+// an ordinary Layer: it can be added to a Network and trained, and
+// get_parameters/get_gradients return tensors over the inline arrays.
+// Results match Linear bit for bit.
+template <size_t In, size_t Out>
+class FixedLinear : public Layer {
+public:
+    static constexpr size_t input_size() { return In; }
+    static constexpr size_t output_size() { return Out; }
+
+    FixedLinear()
+        : weights_view_(Tensor::from_external(weights_.data(), {Out, In})),
+          bias_view_(Tensor::from_external(bias_.data(), {Out, 1})),
+          grad_weights_view_(Tensor::from_external(grad_weights_.data(), {Out, In})),
+          grad_bias_view_(Tensor::from_external(grad_bias_.data(), {Out, 1})) {
+        // Initialize weights randomly
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+
+        for (size_t i = 0; i < weights_.size(); ++i) {
+            weights_[i] = dis(gen);
+        }
+
+        for (size_t i = 0; i < bias_.size(); ++i) {
+            bias_[i] = dis(gen);
+        }
+    }
+
+    // The parameter tensors point into this object
+    FixedLinear(const FixedLinear&) = delete;
+    FixedLinear& operator=(const FixedLinear&) = delete;
+
+    // output = weights * input + bias for a batch of B columns
+    template <size_t B>
+    FixedTensor<Out, B> forward(const FixedTensor<In, B>& input) const {
+        FixedTensor<Out, B> output = matmul(weights_, input);
+        for (size_t o = 0; o < Out; ++o) {
+            for (size_t b = 0; b < B; ++b) {
+                output(o, b) += bias_[o];
+            }
+        }
+        return output;
+    }
+
+    const Tensor& forward(const Tensor& input) override {
+        check_input(input);
+        // Store input for backward pass; shares the buffer when contiguous
+        input_cache_ = input.contiguous();
+        affine_into(output_, input_cache_);
+        return output_;
+    }
+
+    // Writes straight into output and caches nothing, so a Network of
+    // FixedLinear layers predicts without allocating once its buffers exist
+    void infer(const Tensor& input, Tensor& output) override {
+        check_input(input);
+        Tensor scratch;
+        affine_into(output, input.is_contiguous() ? input : (scratch = input.contiguous()));
+    }
+
+    const Tensor& backward(const Tensor& grad_output) override {
+        if (grad_output.rank() != 2 || grad_output.rows() != Out || grad_output.cols() != input_cache_.cols()) {
+            throw std::runtime_error("Gradient shape does not match FixedLinear output");
+        }
+
+        Tensor scratch;
+        const Tensor& g = grad_output.is_contiguous() ? grad_output : (scratch = grad_output.contiguous());
+        const size_t batch = g.cols();
+        const float* gd = g.data();
+        const float* x = input_cache_.data();
+
+        // grad_weights = grad_output * input^T, grad_bias = row sums of grad_output
+        for_each_index<Out>([&](auto o) {
+            for_each_index<In>([&](auto k) {
+                float acc = 0.0f;
+                for (size_t b = 0; b < batch; ++b) {
+                    acc += gd[o * batch + b] * x[k * batch + b];
+                }
+                grad_weights_(o, k) = acc;
+            });
+            float sum = 0.0f;
+            for (size_t b = 0; b < batch; ++b) {
+                sum += gd[o * batch + b];
+            }
+            grad_bias_[o] = sum;
+        });
+
+        // grad_input = weights^T * grad_output
+        grad_input_.resize(In, batch);
+        float* dx = grad_input_.data();
+        for (size_t b = 0; b < batch; ++b) {
+            for_each_index<In>([&](auto k) {
+                float acc = 0.0f;
+                for_each_index<Out>([&](auto o) { acc += weights_(o, k) * gd[o * batch + b]; });
+                dx[k * batch + b] = acc;
+            });
+        }
+        return grad_input_;
+    }
+
+    void update_parameters(float learning_rate) override {
+        weights_view_.axpy_(-learning_rate, grad_weights_view_);
+        bias_view_.axpy_(-learning_rate, grad_bias_view_);
+    }
+
+    std::vector<Tensor*> get_parameters() override { return {&weights_view_, &bias_view_}; }
+    std::vector<Tensor*> get_gradients() override { return {&grad_weights_view_, &grad_bias_view_}; }
+    void clear_cache() override { input_cache_.clear(); }
+
+    void set_weights(const Tensor& weights) {
+        if (weights.shape() == weights_view_.shape()) {
+            weights_ = FixedTensor<Out, In>(weights);
+        }
+    }
+
+    void set_bias(const Tensor& bias) {
+        if (bias.shape() == bias_view_.shape()) {
+            bias_ = FixedTensor<Out, 1>(bias);
+        }
+    }
+
+    const FixedTensor<Out, In>& weights() const { return weights_; }
+    const FixedTensor<Out, 1>& bias() const { return bias_; }
+
+private:
+    static void check_input(const Tensor& input) {
+        if (input.rank() != 2 || input.rows() != In) {
+            throw std::runtime_error("Input size does not match FixedLinear");
+        }
+    }
+
+    // output = weights * x + bias for a contiguous batch x, fully unrolled
+    void affine_into(Tensor& output, const Tensor& x) const {
+        const size_t batch = x.cols();
+        output.resize(Out, batch);
+        const float* xd = x.data();
+        float* y = output.data();
+        for (size_t b = 0; b < batch; ++b) {
+            for_each_index<Out>([&](auto o) {
+                float acc = 0.0f;
+                for_each_index<In>([&](auto k) { acc += weights_(o, k) * xd[k * batch + b]; });
+                y[o * batch + b] = acc + bias_[o];
+            });
+        }
+    }
+
+    FixedTensor<Out, In> weights_;
+    FixedTensor<Out, 1> bias_;
+    FixedTensor<Out, In> grad_weights_;
+    FixedTensor<Out, 1> grad_bias_;
+
+    // Layer API views over the arrays above
+    Tensor weights_view_;
+    Tensor bias_view_;
+    Tensor grad_weights_view_;
+    Tensor grad_bias_view_;
+
+    Tensor input_cache_;  // Store input for backward pass
+    Tensor output_;
+    Tensor grad_input_;
+};
+
+} // namespace nn
+
+#endif // FIXED_LAYER_H
@@ -0,0 +1,129 @@
+#ifndef FIXED_TENSOR_H
+#define FIXED_TENSOR_H
+
+#include "Tensor.h"
+#include <cstddef>
+#include <utility>
+
+namespace nn {
+
+// Calls f(std::integral_constant<size_t, I>{}) for I = 0 .. N-1 with the
+// loop fully unrolled at compile time
+template <typename F, size_t... I>
+inline void unroll_impl(F&& f, std::index_sequence<I...>) {
+    (f(std::integral_constant<size_t, I>{}), ...);
+}
+
+template <size_t N, typename F>
+inline void unroll(F&& f) {
+    unroll_impl(f, std::make_index_sequence<N>{});
+}
+
+// unroll<N> for short loops; longer ones stay loops to bound code size
+template <size_t N, typename F>
+inline void for_each_index(F&& f) {
+    if constexpr (N <= 64) {
+        unroll<N>(f);
+    } else {
+        for (size_t i = 0; i < N; ++i) {
+            f(i);
+        }
+    }
+}
+
+// Matrix of compile-time shape R x C held inline, for tiny models where
+// allocation, virtual dispatch and runtime shape checks would dominate the
+// arithmetic. Shapes are checked by the type system; mismatched operands do
+// not compile.
+template <size_t R, size_t C>
+class FixedTensor {
+public:
+    static_assert(R > 0 && C > 0, "FixedTensor dimensions must be positive");
+
+    static constexpr size_t rows() { return R; }
+    static constexpr size_t cols() { return C; }
+    static constexpr size_t size() { return R * C; }
+
+    FixedTensor() : data_{} {}
+
+    // Copy of a Tensor of the same shape
+    explicit FixedTensor(const Tensor& tensor) {
+        if (tensor.rank() != 2 || tensor.rows() != R || tensor.cols() != C) {
+            throw std::runtime_error("Tensor shape does not match FixedTensor");
+        }
+        for (size_t i = 0; i < R * C; ++i) {
+            data_[i] = tensor[i];
+        }
+    }
+
+    float& operator()(size_t row, size_t col) { return data_[row * C + col]; }
+    float operator()(size_t row, size_t col) const { return data_[row * C + col]; }
+    float& operator[](size_t index) { return data_[index]; }
+    float operator[](size_t index) const { return data_[index]; }
+
+    float* data() { return data_; }
+    const float* data() const { return data_; }
+
+    void fill(float value) {
+        for (size_t i = 0; i < R * C; ++i) {
+            data_[i] = value;
+        }
+    }
+
+    Tensor to_tensor() const { return Tensor(std::vector<float>(data_, data_ + R * C), {R, C}); }
+
+private:
+    float data_[R * C];
+};
+
+// Problems larger than this are left to ordinary loops, which the compiler
+// still specializes on the constant bounds
+constexpr size_t FIXED_UNROLL_LIMIT = 4096;
+
+// C = A * B, accumulating each element in increasing k order from zero so
+// results match sgemm bit for bit
+template <size_t M, size_t K, size_t N>
+inline FixedTensor<M, N> matmul(const FixedTensor<M, K>& a, const FixedTensor<K, N>& b) {
+    FixedTensor<M, N> c;
+    if constexpr (M * K * N <= FIXED_UNROLL_LIMIT) {
+        unroll<M>([&](auto i) {
+            unroll<N>([&](auto j) {
+                float acc = 0.0f;
+                unroll<K>([&](auto k) { acc += a(i, k) * b(k, j); });
+                c(i, j) = acc;
+            });
+        });
+    } else {
+        for (size_t i = 0; i < M; ++i) {
+            for (size_t j = 0; j < N; ++j) {
+                float acc = 0.0f;
+                for (size_t k = 0; k < K; ++k) {
+                    acc += a(i, k) * b(k, j);
+                }
+                c(i, j) = acc;
+            }
+        }
+    }
+    return c;
+}
+
+// Sigmoid through the vectorized math kernels
+template <size_t R, size_t C>
+inline FixedTensor<R, C> sigmoid(const FixedTensor<R, C>& x, MathPrecision precision = MathPrecision::Accurate) {
+    FixedTensor<R, C> y;
+    math::sigmoid(x.data(), y.data(), R * C, precision);
+    return y;
+}
+
+template <size_t R, size_t C>
+inline FixedTensor<R, C> relu(const FixedTensor<R, C>& x) {
+    FixedTensor<R, C> y;
+    for (size_t i = 0; i < R * C; ++i) {
+        y[i] = x[i] > 0.0f ? x[i] : 0.0f;
+    }
+    return y;
+}
+
+} // namespace nn
+
+#endif // FIXED_TENSOR_H
@@ -0,0 +1,66 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include "FastMath.h"
+#include "Half.h"
+#include <cstddef>
+
+namespace nn {
+
+// Whether a GEMM operand is read as stored or as its transpose
+enum class Transpose {
+    No,
+    Yes
+};
+
+// Element-wise function applied after a layer's affine transform
+enum class Activation {
+    Identity,
+    Sigmoid,
+    ReLU
+};
+
+// Work applied to each tile of C once its last block of k is accumulated,
+// while the tile is still hot: C(i, j) = activation(C(i, j) + bias[i]).
+// The result is bit-identical to separate bias and activation passes.
+struct GemmEpilogue {
+    const float* bias = nullptr;  // One value per row of C, or null for none
+    Activation activation = Activation::Identity;
+    MathPrecision precision = MathPrecision::Accurate;
+};
+
+// Single-precision matrix multiply on row-major buffers: C = op(A) * op(B)
+//   op(A) is (M x K); A is stored (M x K), or (K x M) when trans_a is Yes
+//   op(B) is (K x N); B is stored (K x N), or (N x K) when trans_b is Yes
+//   lda/ldb are the row strides of A and B as stored
+//   C is (M x N) with row stride ldc, overwritten with the result
+//
+// Transposed operands are read in place while packing, never copied.
+// Every C(i, j) is accumulated in increasing k order starting from zero, so
+// the result is bit-identical to a naive triple loop.
+void sgemm(Transpose trans_a, Transpose trans_b,
+           size_t M, size_t N, size_t K,
+           const float* A, size_t lda,
+           const float* B, size_t ldb,
+           float* C, size_t ldc);
+
+// C = A * B
+void sgemm(size_t M, size_t N, size_t K,
+           const float* A, size_t lda,
+           const float* B, size_t ldb,
+           float* C, size_t ldc);
+
+// sgemm on operands stored as float32, bfloat16 or float16. Elements are
+// widened to float while packing, so C and the accumulation stay float32
+// and the result equals sgemm on the widened operands. lda and ldb count
+// elements, not bytes.
+void gemm(Transpose trans_a, Transpose trans_b,
+          size_t M, size_t N, size_t K,
+          const void* A, DType a_type, size_t lda,
+          const void* B, DType b_type, size_t ldb,
+          float* C, size_t ldc,
+          const GemmEpilogue& epilogue = GemmEpilogue());
+
+} // namespace nn
+
+#endif // GEMM_H
@@ -0,0 +1,93 @@
+#ifndef HALF_H
+#define HALF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace nn {
+
+// Element type of a tensor's storage. Arithmetic always happens in float32;
+// the 16-bit types only halve the memory and bandwidth of stored data.
+//   BFloat16: float32's exponent range with 8 significant bits
+//   Float16:  IEEE half precision, 11 significant bits, range +-65504
+enum class DType {
+    Float32,
+    BFloat16,
+    Float16
+};
+
+inline size_t dtype_size(DType dtype) {
+    return dtype == DType::Float32 ? 4 : 2;
+}
+
+inline const char* dtype_name(DType dtype) {
+    switch (dtype) {
+        case DType::Float32: return "float32";
+        case DType::BFloat16: return "bfloat16";
+        case DType::Float16: return "float16";
+    }
+    return "unknown";
+}
+
+// Scalar conversions. Narrowing rounds to nearest even and turns NaNs
+// quiet, matching the SIMD conversion kernels bit for bit.
+inline uint32_t float_bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bits_float(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+inline float bf16_to_float(uint16_t h) {
+    return bits_float(static_cast<uint32_t>(h) << 16);
+}
+
+inline uint16_t float_to_bf16(float f) {
+    const uint32_t u = float_bits(f);
+    if ((u & 0x7fffffffu) > 0x7f800000u) {
+        return static_cast<uint16_t>((u >> 16) | 0x40u);  // Quiet NaN
+    }
+    return static_cast<uint16_t>((u + 0x7fffu + ((u >> 16) & 1u)) >> 16);
+}
+
+inline float fp16_to_float(uint16_t h) {
+    const uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+    const uint32_t rest = h & 0x7fffu;
+    if (rest >= 0x7c00u) {
+        // Infinity, or NaN made quiet
+        const uint32_t mantissa = (rest & 0x3ffu) << 13;
+        return bits_float(sign | 0x7f800000u | mantissa | (mantissa ? 0x400000u : 0u));
+    }
+    // Rebias the exponent by scaling; exact for normals and subnormals
+    return bits_float(float_bits(bits_float(rest << 13) * 0x1p112f) | sign);
+}
+
+inline uint16_t float_to_fp16(float f) {
+    uint32_t u = float_bits(f);
+    const uint32_t sign = u & 0x80000000u;
+    u ^= sign;
+    uint32_t h;
+    if (u >= 0x47800000u) {
+        // Overflow to infinity; NaNs keep the top of their payload
+        h = u > 0x7f800000u ? 0x7e00u | ((u & 0x7fffffu) >> 13) : 0x7c00u;
+    } else if (u < 0x38800000u) {
+        // Subnormal or zero: let a float addition do the rounding
+        const uint32_t magic = 126u << 23;
+        h = float_bits(bits_float(u) + bits_float(magic)) - magic;
+    } else {
+        const uint32_t odd = (u >> 13) & 1u;
+        u += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffu + odd;
+        h = u >> 13;
+    }
+    return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+} // namespace nn
+
+#endif // HALF_H
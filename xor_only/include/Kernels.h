@@ -0,0 +1,194 @@
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "FastMath.h"
+#include "Half.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace nn {
+namespace kernels {
+
+// Instruction sets with a dedicated kernel variant
+enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+// Element-wise float kernels; out may alias any input
+struct ElementwiseKernels {
+    void (*add)(const float* a, const float* b, float* out, size_t n);
+    void (*sub)(const float* a, const float* b, float* out, size_t n);
+    void (*mul)(const float* a, const float* b, float* out, size_t n);
+    void (*max)(const float* a, const float* b, float* out, size_t n);  // b where either is NaN
+    void (*add_scalar)(const float* a, float scalar, float* out, size_t n);
+    void (*mul_scalar)(const float* a, float scalar, float* out, size_t n);
+    void (*fill)(float* out, float value, size_t n);
+    void (*relu)(const float* a, float* out, size_t n);
+    void (*axpy)(float alpha, const float* x, float* y, size_t n);  // y += alpha * x
+    // Gradient g through an activation, from the activation's output y
+    void (*sigmoid_backward)(const float* y, const float* g, float* out, size_t n);  // g * (y * (1 - y))
+    void (*relu_backward)(const float* y, const float* g, float* out, size_t n);     // y > 0 ? g : 0
+};
+
+// Transcendental float kernels for one accuracy tier; out may alias in
+struct MathKernels {
+    void (*exp)(const float* in, float* out, size_t n);
+    void (*log)(const float* in, float* out, size_t n);
+    void (*sigmoid)(const float* in, float* out, size_t n);
+    void (*tanh)(const float* in, float* out, size_t n);
+};
+
+// Reductions of a contiguous array. Every variant of sum adds in the same
+// order and returns the same bits as the scalar reference.
+struct ReductionKernels {
+    float (*sum)(const float* x, size_t n);  // Pairwise, error grows with log(n)
+    float (*max)(const float* x, size_t n);  // Skips NaNs; -inf if there is no number
+};
+
+// Conversions between float32 and the 16-bit storage types, rounding to
+// nearest even. Every variant produces the same bits.
+struct ConversionKernels {
+    void (*bf16_to_float)(const uint16_t* in, float* out, size_t n);
+    void (*float_to_bf16)(const float* in, uint16_t* out, size_t n);
+    void (*fp16_to_float)(const uint16_t* in, float* out, size_t n);
+    void (*float_to_fp16)(const float* in, uint16_t* out, size_t n);
+};
+
+// Shape of the int32 tile computed by QuantizedKernels::tile
+constexpr size_t QUANT_TILE_ROWS = 4;
+constexpr size_t QUANT_TILE_COLS = 16;
+
+// Kernels of the int8 inference path. Weights are int8 and activations
+// unsigned 0..127; every variant returns the same integers.
+struct QuantizedKernels {
+    // c (QUANT_TILE_ROWS x QUANT_TILE_COLS, row-major) = sums over quads of
+    // k of the products of a (QUANT_TILE_ROWS rows, 4 bytes each per quad)
+    // and b (QUANT_TILE_COLS columns, 4 bytes each per quad)
+    void (*tile)(size_t quads, const int8_t* a, const uint8_t* b, int32_t* c);
+    // out = clamp(round(in * inv_scale + zero_point), 0, 127)
+    void (*quantize)(const float* in, uint8_t* out, size_t n, float inv_scale, float zero_point);
+};
+
+// Rows per block of the blocked sparse format
+constexpr size_t SPARSE_BLOCK_ROWS = 4;
+
+// Sparse rows times a dense row-major matrix x. Each output is summed in
+// the order of the stored blocks; every variant produces the same bits.
+struct SparseKernels {
+    // out (1 x n) = sum over p < blocks of values[p] * (row cols[p] of x)
+    void (*csr)(size_t blocks, const uint32_t* cols, const float* values,
+                const float* x, size_t ldx, float* out, size_t ldo, size_t n);
+    // The same for SPARSE_BLOCK_ROWS output rows (row stride ldo), with
+    // SPARSE_BLOCK_ROWS values per block
+    void (*blocked)(size_t blocks, const uint32_t* cols, const float* values,
+                    const float* x, size_t ldx, float* out, size_t ldo, size_t n);
+};
+
+// Register-tile kernel of the blocked GEMM (Gemm.h). a holds mr rows and b
+// nr columns of packed panels, both laid out k-major and zero-padded to the
+// tile shape. Every variant sums in increasing k with separate multiplies
+// and adds, so all produce the same bits whatever their tile shape.
+struct GemmTile {
+    size_t mr;  // Tile rows
+    size_t nr;  // Tile columns
+    // C tile (rows x cols, row stride ldc) = (accumulate ? C tile : 0) +
+    // a * b, plus bias[i] on row i when bias is not null
+    void (*kernel)(size_t kc, const float* a, const float* b, float* c, size_t ldc,
+                   size_t rows, size_t cols, bool accumulate, const float* bias);
+};
+
+// The wide tile serves most products. Products with fewer than wide.nr
+// columns, such as a layer applied to a few samples, use the narrow tile,
+// which multiplies less padding.
+struct GemmKernels {
+    GemmTile wide;
+    GemmTile narrow;
+};
+
+// Hyperparameters of one SGD step, see Optimizer.h. With momentum,
+// velocity = momentum * velocity + grad and w -= learning_rate * velocity
+// (or grad + momentum * velocity with Nesterov); grad includes
+// weight_decay * w.
+struct SgdStep {
+    float learning_rate;
+    float momentum;  // 0 leaves velocity unused
+    float weight_decay;
+    bool nesterov;
+};
+
+// Hyperparameters of one Adam step with the bias corrections folded in:
+// step_size = learning_rate / (1 - beta1^t) and inv_sqrt_correction2 =
+// 1 / sqrt(1 - beta2^t). weight_decay adds an L2 term to the gradient
+// (Adam); decay multiplies the weights first (AdamW, 1 for none).
+struct AdamStep {
+    float step_size;
+    float beta1;
+    float beta2;
+    float epsilon;
+    float inv_sqrt_correction2;
+    float weight_decay;
+    float decay;
+};
+
+// Fused parameter updates: each reads the gradient g and updates the
+// parameters w and their state in place in one pass. Every variant
+// produces the same bits.
+struct OptimizerKernels {
+    void (*sgd)(const float* g, float* w, float* velocity, size_t n, const SgdStep& step);
+    void (*adam)(const float* g, float* w, float* m, float* v, size_t n, const AdamStep& step);
+};
+
+// Best instruction set supported by this CPU and build
+Isa detect_isa();
+
+// Instruction set behind elementwise(); picked once on first use from
+// detect_isa(), optionally capped by the NN_ISA environment variable
+// (scalar, sse2, avx2, avx512)
+Isa active_isa();
+
+bool isa_supported(Isa isa);
+const char* isa_name(Isa isa);
+
+// Kernels for the active instruction set
+const ElementwiseKernels& elementwise();
+
+// Kernels for a specific instruction set, e.g. to compare a SIMD variant
+// against the scalar reference. Throws if the ISA is not supported.
+const ElementwiseKernels& elementwise(Isa isa);
+
+// Reduction kernels for the active instruction set
+const ReductionKernels& reductions();
+const ReductionKernels& reductions(Isa isa);
+
+// Conversion kernels for the active instruction set
+const ConversionKernels& conversions();
+const ConversionKernels& conversions(Isa isa);
+
+// Quantized kernels for the active instruction set. The AVX-512 variant
+// uses VNNI when the CPU has it.
+const QuantizedKernels& quantized();
+const QuantizedKernels& quantized(Isa isa);
+
+// Sparse kernels for the active instruction set
+const SparseKernels& sparse();
+const SparseKernels& sparse(Isa isa);
+
+// GEMM tile kernels for the active instruction set
+const GemmKernels& gemm();
+const GemmKernels& gemm(Isa isa);
+
+// Optimizer kernels for the active instruction set
+const OptimizerKernels& optimizer();
+const OptimizerKernels& optimizer(Isa isa);
+
+// Transcendental kernels for the active instruction set
+const MathKernels& math(MathPrecision precision);
+const MathKernels& math(Isa isa, MathPrecision precision);
+
+} // namespace kernels
+} // namespace nn
+
+#endif // KERNELS_H
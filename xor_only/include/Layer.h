@@ -1,34 +1,109 @@
 #ifndef LAYER_H
 #define LAYER_H
 
+#include "Quantize.h"
+#include "Sparse.h"
 #include "Tensor.h"
 
 namespace nn {
 
+// forward and backward return a reference to a buffer owned by the layer.
+// It stays valid until the next call of the same method, which lets
+// layers reuse their buffers and avoid allocating on every step.
+// update_parameters may run on another thread while earlier layers are
+// still in backward, so it must only touch the layer's own state.
 class Layer {
 public:
     virtual ~Layer() = default;
-    virtual Tensor forward(const Tensor& input) = 0;
-    virtual Tensor backward(const Tensor& grad_output) = 0;
+    virtual const Tensor& forward(const Tensor& input) = 0;
+    virtual const Tensor& backward(const Tensor& grad_output) = 0;
     virtual void update_parameters(float learning_rate) = 0;
     virtual std::vector<Tensor*> get_parameters() = 0;  // Get parameters for optimizers
     virtual std::vector<Tensor*> get_gradients() = 0;   // Get gradients for optimizers
+    // Called after an optimizer has written to get_parameters(), so the
+    // layer can refresh state derived from them
+    virtual void parameters_updated() {}
+    
+    // Forward pass for inference: writes the result to output, a buffer
+    // owned by the caller, and keeps nothing for backward. output is never
+    // input. The default runs forward and shares its result, so layers
+    // override it to write output directly.
+    virtual void infer(const Tensor& input, Tensor& output) {
+        output = forward(input);
+        clear_cache();
+    }
+    virtual void set_math_precision(MathPrecision) {}  // Accuracy tier for activations
+    virtual void set_storage_type(DType) {}  // Element type of stored weights and activations
+    
+    // Name recorded by Network::save, or null for layers it cannot save
+    virtual const char* type_name() const { return nullptr; }
+    
+    // Switch to int8 inference, calibrating the input range on a sample of
+    // inputs; backward is unavailable until dequantize()
+    virtual void quantize(const Tensor& /*calibration_input*/) {}
+    virtual void dequantize() {}
+
+    // Drop tensors kept only for backward. Cached tensors share their
+    // buffer with the layer that produced them, which would otherwise have
+    // to copy it on its next write.
+    virtual void clear_cache() {}
 };
 
 class Linear : public Layer {
 public:
-    Linear(size_t input_size, size_t output_size);
+    Linear(size_t input_size, size_t output_size, Activation activation = Activation::Identity);
+    
+    // Takes the tensors as they are, so weights from Tensor::from_external
+    // keep pointing at their memory; the storage type is the weights' dtype
+    Linear(Tensor weights, Tensor bias);
+    
+    const char* type_name() const override { return "Linear"; }
     
-    Tensor forward(const Tensor& input) override;
-    Tensor backward(const Tensor& grad_output) override;
+    const Tensor& forward(const Tensor& input) override;
+    const Tensor& backward(const Tensor& grad_output) override;
+    void infer(const Tensor& input, Tensor& output) override;
     void update_parameters(float learning_rate) override;
     std::vector<Tensor*> get_parameters() override;
     std::vector<Tensor*> get_gradients() override;
+    void parameters_updated() override;
+    void clear_cache() override;
+    void set_math_precision(MathPrecision precision) override { precision_ = precision; }
+    
+    // Activation applied to the output by the GEMM epilogue, so that no
+    // separate activation layer or pass over the output is needed;
+    // backward applies its derivative in the pass computing grad_bias
+    void set_activation(Activation activation) { activation_ = activation; }
+    Activation get_activation() const { return activation_; }
+    
+    // Weights and the cached input are stored as dtype and widened to
+    // float32 inside the GEMM; the bias and the gradients stay float32
+    void set_storage_type(DType dtype) override;
+    DType get_storage_type() const { return storage_type_; }
+    
+    // Int8 weights with per-output-channel scales and 7-bit activations
+    void quantize(const Tensor& calibration_input) override;
+    void quantize(const ActivationQuantization& input);
+    void dequantize() override { quantized_weights_ = QuantizedMatrix(); }
+    bool is_quantized() const { return !quantized_weights_.empty(); }
+    const QuantizedMatrix& get_quantized_weights() const { return quantized_weights_; }
+    
+    // Sparse weights: forward multiplies a sparse copy of the weights when
+    // at most SPARSE_MAX_DENSITY of them are stored. prune() zeroes the
+    // smallest weights (in 4-row blocks for the blocked format) and picks
+    // the path; call update_sparse_weights() after pruning the weights
+    // through get_parameters(). Training keeps the pruned entries at zero.
+    void prune(float sparsity, SparseFormat format = SparseFormat::CSR);
+    void update_sparse_weights(SparseFormat format = SparseFormat::CSR);
+    bool is_sparse() const { return !sparse_weights_.empty(); }
+    const SparseMatrix& get_sparse_weights() const { return sparse_weights_; }
     
     void set_weights(const Tensor& weights);
     void set_bias(const Tensor& bias);
     
 private:
+    Activation activation_ = Activation::Identity;
+    MathPrecision precision_ = MathPrecision::Accurate;
+    DType storage_type_ = DType::Float32;
     Tensor weights_;
     Tensor bias_;
     Tensor input_cache_;  // Store input for backward pass
@@ -36,20 +111,57 @@ private:
     // Gradients
     Tensor grad_weights_;
     Tensor grad_bias_;
+    
+    // Reused output buffers
+    Tensor output_;
+    Tensor grad_input_;
+    Tensor grad_pre_activation_;  // Gradient through the activation
+    
+    // Copy of the weights used by forward, empty unless sparse enough
+    SparseMatrix sparse_weights_;
+    
+    // Inference-only copy of the weights, empty unless quantized
+    QuantizedMatrix quantized_weights_;
+    ActivationQuantization input_quantization_;
 };
 
 class Sigmoid : public Layer {
 public:
     Sigmoid() = default;
     
-    Tensor forward(const Tensor& input) override;
-    Tensor backward(const Tensor& grad_output) override;
+    const char* type_name() const override { return "Sigmoid"; }
+    
+    const Tensor& forward(const Tensor& input) override;
+    const Tensor& backward(const Tensor& grad_output) override;
+    void infer(const Tensor& input, Tensor& output) override { sigmoid_into(output, input, precision_); }
     void update_parameters(float learning_rate) override {}
     std::vector<Tensor*> get_parameters() override { return {}; }
     std::vector<Tensor*> get_gradients() override { return {}; }
+    void set_math_precision(MathPrecision precision) override { precision_ = precision; }
+    MathPrecision get_math_precision() const { return precision_; }
+    
+private:
+    Tensor output_cache_;  // Store output for backward pass
+    Tensor grad_input_;
+    MathPrecision precision_ = MathPrecision::Accurate;
+};
+
+class ReLU : public Layer {
+public:
+    ReLU() = default;
+    
+    const char* type_name() const override { return "ReLU"; }
+    
+    const Tensor& forward(const Tensor& input) override;
+    const Tensor& backward(const Tensor& grad_output) override;
+    void infer(const Tensor& input, Tensor& output) override { relu_into(output, input); }
+    void update_parameters(float) override {}
+    std::vector<Tensor*> get_parameters() override { return {}; }
+    std::vector<Tensor*> get_gradients() override { return {}; }
     
 private:
     Tensor output_cache_;  // Store output for backward pass
+    Tensor grad_input_;
 };
 
 } // namespace nn
@@ -10,12 +10,26 @@ public:
     virtual ~Loss() = default;
     virtual float compute(const Tensor& predicted, const Tensor& actual) = 0;
     virtual Tensor compute_gradient(const Tensor& predicted, const Tensor& actual) = 0;
+    
+    // Writes the gradient into an existing tensor, reusing its buffer
+    virtual void compute_gradient_into(Tensor& gradient, const Tensor& predicted, const Tensor& actual) {
+        gradient = compute_gradient(predicted, actual);
+    }
+    
+    // The loss and its gradient together, as Network::train_step needs
+    // them. Losses that can should override this with a single pass.
+    virtual float compute_with_gradient(Tensor& gradient, const Tensor& predicted, const Tensor& actual) {
+        compute_gradient_into(gradient, predicted, actual);
+        return compute(predicted, actual);
+    }
 };
 
 class MSELoss : public Loss {
 public:
     float compute(const Tensor& predicted, const Tensor& actual) override;
     Tensor compute_gradient(const Tensor& predicted, const Tensor& actual) override;
+    void compute_gradient_into(Tensor& gradient, const Tensor& predicted, const Tensor& actual) override;
+    float compute_with_gradient(Tensor& gradient, const Tensor& predicted, const Tensor& actual) override;
 };
 
 } // namespace nn
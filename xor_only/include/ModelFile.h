@@ -0,0 +1,81 @@
+#ifndef MODEL_FILE_H
+#define MODEL_FILE_H
+
+#include "Shape.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace nn {
+
+// Binary model format written by Network::save. Integers are stored in the
+// byte order of the writing machine, recorded by byte_order_mark.
+//
+//   ModelHeader
+//   for each layer: LayerRecord, then tensor_count TensorRecords
+//   padding, then the raw tensor data, each section starting at a
+//   multiple of MODEL_ALIGNMENT bytes from the start of the file
+//
+// Readers reject other major versions; minor versions only add fields in
+// reserved space and stay readable.
+constexpr char MODEL_MAGIC[8] = {'N', 'N', 'M', 'O', 'D', 'E', 'L', '\0'};
+constexpr uint16_t MODEL_VERSION_MAJOR = 1;
+constexpr uint16_t MODEL_VERSION_MINOR = 1;
+constexpr uint32_t MODEL_BYTE_ORDER_MARK = 0x01020304;
+constexpr size_t MODEL_ALIGNMENT = 64;
+
+struct ModelHeader {
+    char magic[8];
+    uint16_t version_major;
+    uint16_t version_minor;
+    uint32_t byte_order_mark;
+    uint64_t file_size;
+    uint32_t layer_count;
+    uint32_t math_precision;  // MathPrecision of the network
+    uint32_t storage_type;    // DType of the network
+    uint32_t reserved[7];
+};
+static_assert(sizeof(ModelHeader) == 64, "ModelHeader layout");
+
+struct LayerRecord {
+    char type[24];  // Layer::type_name(), zero-padded
+    uint32_t tensor_count;
+    uint32_t activation;  // Activation of a Linear layer (version 1.1), otherwise 0
+};
+static_assert(sizeof(LayerRecord) == 32, "LayerRecord layout");
+
+// One of the layer's get_parameters(), stored contiguously
+struct TensorRecord {
+    uint32_t dtype;
+    uint32_t rank;
+    uint64_t shape[Shape::MAX_RANK];
+    uint64_t offset;  // From the start of the file, a multiple of MODEL_ALIGNMENT
+    uint64_t bytes;
+};
+static_assert(sizeof(TensorRecord) == 72, "TensorRecord layout");
+
+// A whole file mapped into memory. The mapping is private and writable:
+// pages are shared with every other process mapping the file until one is
+// written, which copies that page and never changes the file. Platforms
+// without mmap read the file into memory instead.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    char* data() { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    char* buffer_ = nullptr;  // Allocation holding data_ when the file is read instead
+};
+
+} // namespace nn
+
+#endif // MODEL_FILE_H
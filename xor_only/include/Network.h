@@ -2,6 +2,10 @@
 #define NETWORK_H
 
 #include "Layer.h"
+#include "Loss.h"
+#include "Optimizer.h"
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace nn {
@@ -12,15 +16,90 @@ public:
     ~Network(); // Added destructor for memory cleanup
     
     void add_layer(Layer* layer);
-    Tensor forward(const Tensor& input);
+    // Inference: each layer writes straight into one of two activation
+    // buffers owned by the network, alternating between them, and caches
+    // nothing for backward. The result is valid until the next predict or
+    // forward.
+    const Tensor& predict(const Tensor& input);
+    const Tensor& forward(const Tensor& input) { return predict(input); }
+    // One gradient descent step on a batch of samples, one per column. The
+    // gradients are averaged over the batch (see Trainer for whole datasets).
     void train_step(const Tensor& input, const Tensor& target, float learning_rate);
+    // The same step minimizing loss instead, whose value and gradient come
+    // from the step's single forward pass. Returns the loss before the update.
+    float train_step(const Tensor& input, const Tensor& target, Loss& loss, float learning_rate);
+    
+    // Optimizer used by train_step in place of each layer's plain gradient
+    // descent update. It updates every parameter in one pass once backward
+    // has finished, taking the learning rate from train_step. Null (the
+    // default) restores the per-layer updates.
+    void set_optimizer(std::unique_ptr<Optimizer> optimizer) { optimizer_ = std::move(optimizer); }
+    Optimizer* get_optimizer() const { return optimizer_.get(); }
+    
+    // Accuracy tier used by every activation layer, including ones added later
+    void set_math_precision(MathPrecision precision);
+    MathPrecision get_math_precision() const { return math_precision_; }
+    
+    // Optimize the layer list in place: an activation layer after a Linear
+    // layer becomes that layer's fused activation, and a ReLU after a ReLU
+    // (or after a Linear ending in one) is dropped. Results and parameters
+    // are unchanged. Removed layers are deleted, so pointers to them from
+    // get_layers() become invalid.
+    void compile();
+    
+    // Element type of stored weights and activations in every layer,
+    // including ones added later. Arithmetic stays float32.
+    void set_storage_type(DType dtype);
+    DType get_storage_type() const { return storage_type_; }
+    
+    // Switch every layer to int8 inference. Each layer calibrates its input
+    // range on what the layers before it produce for calibration_input, so
+    // pass a representative sample. train_step throws until dequantize().
+    void quantize(const Tensor& calibration_input);
+    void dequantize();
+    bool is_quantized() const { return quantized_; }
+    
+    // Binary model file (see ModelFile.h): the layer list, precision and
+    // storage type, and every parameter as a raw 64-byte-aligned section.
+    // load replaces the layers and maps the file rather than reading it, so
+    // Linear weights point straight into the mapping and pages are read
+    // from disk when first used. Writes to loaded weights (training) stay
+    // private to this network. Quantized and sparse copies of the weights
+    // are not saved; call quantize() or update_sparse_weights() again.
+    void save(const std::string& path) const;
+    void load(const std::string& path);
+    
+    // Allocate the temporaries of forward and train_step from a per-thread
+    // arena that is released when the call returns (on by default)
+    void set_use_arena(bool enabled) { use_arena_ = enabled; }
+    bool get_use_arena() const { return use_arena_; }
     
     std::vector<Layer*>& get_layers() { return layers_; }
     const std::vector<Layer*>& get_layers() const { return layers_; }
     
 private:
+    // Parameter update of one layer, run as a task during backward
+    struct ParameterUpdate {
+        Layer* layer = nullptr;
+        float learning_rate = 0.0f;
+        size_t parameters = 0;
+        void operator()() const { layer->update_parameters(learning_rate); }
+    };
+    
+    // Forward, backward and update of train_step; without a loss the
+    // gradient is that of the summed squared error, and 0 is returned
+    float step(const Tensor& input, const Tensor& target, Loss* loss, float learning_rate);
+    
     std::vector<Layer*> layers_;
-    std::vector<Tensor> layer_outputs_;  // Cache outputs for backward pass
+    std::vector<ParameterUpdate> updates_;  // One per layer, rebuilt when layers_ changes
+    Tensor activations_[2];  // Ping-pong buffers of predict
+    Tensor grad_output_;  // Loss gradient buffer reused across steps
+    MathPrecision math_precision_ = MathPrecision::Accurate;
+    DType storage_type_ = DType::Float32;
+    bool use_arena_ = true;
+    bool quantized_ = false;
+    std::unique_ptr<Optimizer> optimizer_;
+    std::shared_ptr<void> model_file_;  // Mapping the loaded layers point into
 };
 
 } // namespace nn
@@ -0,0 +1,112 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "Kernels.h"
+#include "Layer.h"
+#include <vector>
+
+namespace nn {
+
+// Updates the parameters of a list of layers from their gradients, found
+// through Layer::get_parameters() and get_gradients(). One step updates
+// every parameter in a single pass split across threads, with fused
+// kernels that read each gradient and update the parameter and its state
+// together. The state (velocities or moments) lives in one contiguous
+// float32 buffer created on the first step and kept while the layers
+// present the same parameters. 16-bit parameters are widened, updated and
+// rounded back in chunks.
+class Optimizer {
+public:
+    virtual ~Optimizer() = default;
+
+    // One update of every parameter of layers. Gradients must match their
+    // parameters' sizes, so run backward first.
+    void step(const std::vector<Layer*>& layers, float learning_rate);
+
+    // Drop the state; the next step starts from zero velocities or moments.
+    // Also done when the layer list or a parameter's size changes.
+    virtual void reset();
+
+protected:
+    // slots: floats of state per parameter element
+    explicit Optimizer(size_t slots) : slots_(slots) {}
+
+    // Called once per step before any update
+    virtual void begin_step(float learning_rate) = 0;
+    // Updates n elements of w from g. Slot k of their state starts at
+    // state + k * slot_stride, and state is null without slots.
+    virtual void update(const float* g, float* w, float* state, size_t slot_stride, size_t n) const = 0;
+
+private:
+    // A parameter's place in the pass and in the state buffer
+    struct Segment {
+        Layer* layer;
+        Tensor* parameter;
+        const Tensor* gradient;
+        size_t begin;  // First element of the parameter in the pass
+        size_t size;
+    };
+
+    bool segments_match(const std::vector<Layer*>& layers) const;
+    void build_segments(const std::vector<Layer*>& layers);
+
+    size_t slots_;
+    std::vector<Layer*> layers_;  // Layers the segments were built from
+    std::vector<Segment> segments_;
+    std::vector<const float*> gradients_;  // Per segment, resolved each step
+    std::vector<void*> parameters_;
+    size_t total_ = 0;  // Elements over all parameters
+    Tensor state_;  // slots_ * total_ floats; slot k of a segment at slots_ * begin + k * size
+    bool state_valid_ = false;
+};
+
+// Stochastic gradient descent, with optional momentum (and Nesterov
+// momentum) and an L2 weight decay added to the gradient. Without
+// momentum or decay it computes exactly what Linear::update_parameters does.
+class SGD : public Optimizer {
+public:
+    explicit SGD(float momentum = 0.0f, bool nesterov = false, float weight_decay = 0.0f);
+
+protected:
+    void begin_step(float learning_rate) override;
+    void update(const float* g, float* w, float* state, size_t slot_stride, size_t n) const override;
+
+private:
+    kernels::SgdStep step_;
+};
+
+// Adam with bias-corrected moments. weight_decay is an L2 term added to
+// the gradient, which the moments then rescale.
+class Adam : public Optimizer {
+public:
+    explicit Adam(float beta1 = 0.9f, float beta2 = 0.999f, float epsilon = 1e-8f, float weight_decay = 0.0f);
+
+    void reset() override;
+    size_t get_step_count() const { return steps_; }
+
+protected:
+    Adam(float beta1, float beta2, float epsilon, float weight_decay, bool decoupled);
+
+    void begin_step(float learning_rate) override;
+    void update(const float* g, float* w, float* state, size_t slot_stride, size_t n) const override;
+
+private:
+    float beta1_;
+    float beta2_;
+    float epsilon_;
+    float weight_decay_;
+    bool decoupled_;
+    size_t steps_ = 0;
+    kernels::AdamStep step_;
+};
+
+// Adam with decoupled weight decay: each step first scales the weights by
+// 1 - learning_rate * weight_decay, independent of the gradient history
+class AdamW : public Adam {
+public:
+    explicit AdamW(float beta1 = 0.9f, float beta2 = 0.999f, float epsilon = 1e-8f, float weight_decay = 0.01f);
+};
+
+} // namespace nn
+
+#endif // OPTIMIZER_H
@@ -0,0 +1,59 @@
+#ifndef QUANTIZE_H
+#define QUANTIZE_H
+
+#include "Tensor.h"
+#include <cstdint>
+#include <vector>
+
+namespace nn {
+
+// Affine mapping of activations to unsigned 7-bit integers:
+// q = clamp(round(x / scale) + zero_point, 0, 127). One bit short of a full
+// byte, so the byte multiply-adds of the integer GEMM cannot saturate.
+struct ActivationQuantization {
+    float scale = 1.0f;
+    int32_t zero_point = 0;
+
+    // Covers [min, max], widened to include 0 so that 0 stays exact
+    static ActivationQuantization from_range(float min, float max);
+
+    // Range of the values in a calibration tensor of any dtype
+    static ActivationQuantization calibrate(const Tensor& sample);
+};
+
+// A 2-D weight matrix quantized to int8 with one symmetric scale per row
+// (output channel), packed for the integer GEMM kernel
+class QuantizedMatrix {
+public:
+    QuantizedMatrix() = default;
+    explicit QuantizedMatrix(const Tensor& weights);  // Any dtype
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    bool empty() const { return rows_ == 0; }
+    size_t bytes() const;  // Packed weights and per-row constants
+
+    Tensor dequantize() const;  // Float32 copy, to measure rounding error
+
+private:
+    friend void quantized_linear_into(Tensor& dst, const QuantizedMatrix& weights, const Tensor& x,
+                                      const ActivationQuantization& input, const Tensor& bias);
+
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    size_t quads_ = 0;              // cols_ rounded up to groups of 4
+    std::vector<int8_t> packed_;    // Slivers of QUANT_TILE_ROWS rows, interleaved per quad
+    std::vector<float> scales_;     // Per row
+    std::vector<int32_t> row_sums_; // Per row, to remove the activation zero point
+};
+
+// dst (rows x batch) = weights * x + bias, computed as int8 x uint7 products
+// summed in int32 and scaled back to float32. x (cols x batch, any dtype)
+// is quantized with input; bias is float32 (rows x 1) or empty. The result
+// is the same for every instruction set and thread count.
+void quantized_linear_into(Tensor& dst, const QuantizedMatrix& weights, const Tensor& x,
+                           const ActivationQuantization& input, const Tensor& bias);
+
+} // namespace nn
+
+#endif // QUANTIZE_H
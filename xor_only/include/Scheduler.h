@@ -0,0 +1,231 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace nn {
+
+// Non-owning reference to a callable run on a chunk [begin, end). Unlike
+// std::function it never allocates, whatever the lambda captures.
+class ChunkFn {
+public:
+    template <typename F, typename = typename std::enable_if<
+                              !std::is_same<typename std::decay<F>::type, ChunkFn>::value>::type>
+    ChunkFn(F& f)
+        : object_(const_cast<void*>(static_cast<const void*>(&f))),
+          call_([](void* object, size_t begin, size_t end) { (*static_cast<F*>(object))(begin, end); }) {}
+
+    void operator()(size_t begin, size_t end) const { call_(object_, begin, end); }
+
+private:
+    void* object_;
+    void (*call_)(void*, size_t, size_t);
+};
+
+class TaskGroup;
+
+// Queued unit of work. The callable is referenced, not owned.
+struct Task {
+    void (*call)(void*) = nullptr;
+    void* object = nullptr;
+    TaskGroup* group = nullptr;
+};
+
+// Activity of one scheduler slot since the last reset_stats. Slot 0 is
+// shared by threads outside the scheduler (usually the main thread), so its
+// busy time includes their serial work.
+struct WorkerStats {
+    uint64_t tasks_run = 0;     // Tasks executed in this slot
+    uint64_t tasks_stolen = 0;  // Of those, taken from another slot's queue
+    double busy_seconds = 0.0;
+    double idle_seconds = 0.0;  // Waiting for work, asleep or spinning
+
+    double utilization() const {
+        const double total = busy_seconds + idle_seconds;
+        return total > 0.0 ? busy_seconds / total : 0.0;
+    }
+};
+
+// Work-stealing scheduler. Each of the num_threads - 1 worker threads owns a
+// task deque; threads outside the scheduler share slot 0. A thread pushes
+// and pops its own tasks at the back, and idle workers steal from the front
+// of the others. Waiting on a TaskGroup runs queued tasks instead of
+// blocking, so nested parallel regions (a parallel batch loop calling a
+// parallel matmul) just add tasks and never start more threads than cores.
+class Scheduler {
+public:
+    explicit Scheduler(size_t num_threads);
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    size_t num_threads() const { return slots_.size(); }
+
+    // Runs fn over [0, n) and returns once every chunk is done. The range is
+    // split in halves down to chunks of whole grains, and to no fewer than
+    // a few chunks per thread so that stealing can balance the load.
+    void parallel_for(size_t n, size_t grain, ChunkFn fn);
+
+    // Queues a task on the calling thread's deque. When the deque is full
+    // the task runs immediately.
+    void spawn(const Task& task);
+
+    // Runs one queued task, preferring the caller's own deque. Returns
+    // false if no task was found.
+    bool run_one();
+
+    // Runs queued tasks until pending drops to zero
+    void help_until_done(const std::atomic<size_t>& pending);
+
+    std::vector<WorkerStats> stats() const;
+    void reset_stats();
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+
+    // One deque and its counters, on its own cache lines
+    struct alignas(64) Slot {
+        std::mutex mutex;
+        Task tasks[QUEUE_CAPACITY];
+        size_t head = 0;  // Steal end
+        size_t tail = 0;  // Owner end
+
+        std::atomic<uint64_t> tasks_run{0};
+        std::atomic<uint64_t> tasks_stolen{0};
+        std::atomic<int64_t> idle_ns{0};
+        std::atomic<int64_t> idle_since{0};  // Start of the current idle period, 0 if busy
+    };
+
+    size_t current_slot() const;
+    bool pop(Slot& slot, Task& task);
+    bool steal(Slot& slot, Task& task);
+    void execute(const Task& task, Slot& slot, bool stolen);
+    void worker_loop(size_t index);
+
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_{0};  // Tasks in all deques
+
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    std::atomic<size_t> sleeping_{0};
+    bool stop_ = false;
+
+    std::chrono::steady_clock::time_point stats_start_;
+};
+
+// Thread count used when none is set: NN_NUM_THREADS if present, otherwise
+// the number of hardware threads
+size_t default_num_threads();
+
+// The library-wide scheduler behind every parallel operation, created on
+// first use. set_num_threads replaces it (0 restores the default) and must
+// not be called while parallel work is running.
+Scheduler& scheduler();
+void set_num_threads(size_t num_threads);
+size_t num_threads();
+
+// Fork-join group of tasks on the library scheduler. run() queues a
+// reference to the callable, which must stay alive until wait() returns.
+// wait() runs queued tasks until the group is done and rethrows the first
+// exception a task threw. With a single thread, run() calls the task
+// immediately.
+class TaskGroup {
+public:
+    TaskGroup() : scheduler_(scheduler()) {}
+    ~TaskGroup() { join(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F>
+    void run(F& f) {
+        if (scheduler_.num_threads() == 1) {
+            f();
+            return;
+        }
+        Task task;
+        task.call = [](void* object) { (*static_cast<F*>(object))(); };
+        task.object = const_cast<void*>(static_cast<const void*>(&f));
+        task.group = this;
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        scheduler_.spawn(task);
+    }
+
+    // The task would be destroyed before it runs
+    template <typename F>
+    void run(const F&&) = delete;
+
+    void wait();
+
+private:
+    friend class Scheduler;
+
+    void join();
+    void finish(std::exception_ptr error);
+
+    Scheduler& scheduler_;
+    std::atomic<size_t> pending_{0};
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+// Element counts below two grains stay on the calling thread
+constexpr size_t ELEMENTWISE_GRAIN = 16384;
+
+// Runs f(begin, end) over [0, n) on the library scheduler
+template <typename F>
+void parallel_for(size_t n, size_t grain, F&& f) {
+    if (n < 2 * grain || scheduler().num_threads() == 1) {
+        f(size_t(0), n);
+        return;
+    }
+    scheduler().parallel_for(n, grain, ChunkFn(f));
+}
+
+namespace detail {
+
+template <typename T, typename Map, typename Combine>
+T reduce_range(size_t begin, size_t end, size_t grain, const Map& map, const Combine& combine) {
+    const size_t grains = (end - begin + grain - 1) / grain;
+    if (grains < 2) {
+        return map(begin, end);
+    }
+    const size_t mid = begin + grains / 2 * grain;
+    T right{};
+    auto right_half = [&] { right = reduce_range<T>(mid, end, grain, map, combine); };
+    TaskGroup group;
+    group.run(right_half);
+    T left = reduce_range<T>(begin, mid, grain, map, combine);
+    group.wait();
+    return combine(left, right);
+}
+
+} // namespace detail
+
+// Reduces [0, n): map(begin, end) reduces one chunk of at most grain
+// elements and combine(left, right) merges neighbouring results. The
+// chunks and the combining tree depend only on n and grain, so the result
+// is the same for every thread count.
+template <typename T, typename Map, typename Combine>
+T parallel_reduce(size_t n, size_t grain, T identity, const Map& map, const Combine& combine) {
+    if (n == 0) {
+        return identity;
+    }
+    return detail::reduce_range<T>(0, n, grain == 0 ? 1 : grain, map, combine);
+}
+
+} // namespace nn
+
+#endif // SCHEDULER_H
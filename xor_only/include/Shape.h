@@ -0,0 +1,74 @@
+#ifndef SHAPE_H
+#define SHAPE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+namespace nn {
+
+// Dimensions of a tensor, stored inline so creating a tensor never
+// allocates for its metadata. Also used for strides and index lists.
+class Shape {
+public:
+    static constexpr size_t MAX_RANK = 6;
+
+    Shape() = default;
+
+    Shape(std::initializer_list<size_t> dims) { assign(dims.begin(), dims.end()); }
+
+    // Implicit so existing code comparing or passing std::vector shapes keeps working
+    Shape(const std::vector<size_t>& dims) { assign(dims.begin(), dims.end()); }
+
+    size_t size() const { return rank_; }  // Number of dimensions
+    bool empty() const { return rank_ == 0; }
+
+    size_t& operator[](size_t i) { return dims_[i]; }
+    size_t operator[](size_t i) const { return dims_[i]; }
+
+    const size_t* begin() const { return dims_; }
+    const size_t* end() const { return dims_ + rank_; }
+    size_t* begin() { return dims_; }
+    size_t* end() { return dims_ + rank_; }
+
+    void push_back(size_t dim) {
+        if (rank_ == MAX_RANK) {
+            throw std::runtime_error("Tensor rank exceeds Shape::MAX_RANK");
+        }
+        dims_[rank_++] = dim;
+    }
+
+    // Product of the dimensions; 1 for rank 0
+    size_t numel() const {
+        size_t n = 1;
+        for (size_t i = 0; i < rank_; ++i) {
+            n *= dims_[i];
+        }
+        return n;
+    }
+
+    std::vector<size_t> to_vector() const { return std::vector<size_t>(begin(), end()); }
+
+    friend bool operator==(const Shape& a, const Shape& b) {
+        return a.rank_ == b.rank_ && std::equal(a.begin(), a.end(), b.begin());
+    }
+    friend bool operator!=(const Shape& a, const Shape& b) { return !(a == b); }
+
+private:
+    template <typename It>
+    void assign(It first, It last) {
+        if (static_cast<size_t>(last - first) > MAX_RANK) {
+            throw std::runtime_error("Tensor rank exceeds Shape::MAX_RANK");
+        }
+        rank_ = std::copy(first, last, dims_) - dims_;
+    }
+
+    size_t dims_[MAX_RANK] = {};
+    size_t rank_ = 0;
+};
+
+} // namespace nn
+
+#endif // SHAPE_H
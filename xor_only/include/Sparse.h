@@ -0,0 +1,67 @@
+#ifndef SPARSE_H
+#define SPARSE_H
+
+#include "Tensor.h"
+#include <cstdint>
+#include <vector>
+
+namespace nn {
+
+enum class SparseFormat {
+    CSR,     // Compressed sparse rows; stores exactly the nonzeros
+    Blocked  // Column blocks of 4 rows: each load of the dense operand feeds 4 rows
+};
+
+// A 2-D float32 matrix keeping only its nonzero entries, or for the blocked
+// format its nonzero blocks of kernels::SPARSE_BLOCK_ROWS x 1. Zeros inside
+// a stored block are kept, so the blocked format pays off when pruning
+// removes whole blocks (magnitude_prune with block_rows = 4).
+class SparseMatrix {
+public:
+    SparseMatrix() = default;
+    explicit SparseMatrix(const Tensor& dense, SparseFormat format = SparseFormat::CSR);  // Any dtype
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    SparseFormat format() const { return format_; }
+    bool empty() const { return rows_ == 0; }
+
+    size_t nonzeros() const { return nonzeros_; }
+    size_t stored() const { return values_.size(); }  // Values multiplied, including zeros inside blocks
+    float density() const;                            // stored() / (rows * cols)
+    size_t bytes() const;
+
+    Tensor to_dense() const;
+
+    // Takes the values at the stored positions from dense and zeroes every
+    // other entry of dense, so a pruned pattern survives a parameter update
+    void refresh(Tensor& dense);
+
+private:
+    friend void sparse_matmul_into(Tensor& dst, const SparseMatrix& a, const Tensor& b);
+
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    SparseFormat format_ = SparseFormat::CSR;
+    size_t block_rows_ = 1;
+    size_t nonzeros_ = 0;
+    std::vector<size_t> group_start_;   // First block of each group of block_rows_ rows, plus the end
+    std::vector<uint32_t> block_cols_;  // Column of each block
+    std::vector<float> values_;         // block_rows_ values per block
+};
+
+// dst = a * b for a dense b of any dtype and layout. Time grows with
+// a.stored() * b.cols() rather than with the dense size, and the result is
+// bit for bit the dense product of the same weights.
+void sparse_matmul_into(Tensor& dst, const SparseMatrix& a, const Tensor& b);
+
+// Zeroes the smallest-magnitude fraction sparsity of the entries of the
+// tensors, ranked together under one threshold. With block_rows > 1, 2-D
+// tensors are pruned in column blocks of that many rows, ranked by their
+// summed magnitude. Returns the number of entries zeroed, including ones
+// that were already zero.
+size_t magnitude_prune(const std::vector<Tensor*>& tensors, float sparsity, size_t block_rows = 1);
+
+} // namespace nn
+
+#endif // SPARSE_H
@@ -0,0 +1,89 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include "Allocator.h"
+#include <atomic>
+#include <cstddef>
+
+namespace nn {
+
+// Reference-counted, copy-on-write float buffer drawn from a pluggable
+// Allocator. Copies share the buffer and only duplicate it when one of them
+// asks for mutable access, so caching a tensor costs no memory traffic.
+//
+// New buffers come from the storage's allocator, current_allocator() at
+// construction. Buffers from a transient allocator (an Arena) are never
+// shared with storage that uses a different allocator: copying or moving
+// them there duplicates the data instead, so long-lived tensors never point
+// into a scoped arena. Move construction always duplicates them onto the
+// default allocator, since the new storage may outlive the scope.
+//
+// External storage wraps memory owned by someone else. Writes go straight
+// to that memory and assigning data of the same size copies into it, while
+// copies of external storage get a buffer of their own.
+class Storage {
+public:
+    Storage();
+    explicit Storage(size_t size);                // Zero-initialized
+    Storage(const float* data, size_t size);      // Copy of data
+    Storage(size_t size, Allocator* allocator);   // Zero-initialized, explicit allocator
+
+    // Non-owning storage over memory that must outlive it
+    static Storage external(float* data, size_t size);
+    // Storage whose elements are left uninitialized, for callers that
+    // overwrite every element
+    static Storage uninitialized(size_t size);
+
+    Storage(const Storage& other);
+    Storage& operator=(const Storage& other);
+    Storage(Storage&& other);
+    Storage& operator=(Storage&& other);
+    ~Storage();
+
+    // Mutable access detaches a shared buffer first
+    float* data();
+    const float* data() const { return data_; }
+    size_t size() const { return size_; }
+    size_t capacity() const;
+    Allocator* allocator() const { return allocator_; }
+
+    float& operator[](size_t index) { return data()[index]; }
+    const float& operator[](size_t index) const { return data_[index]; }
+
+    // True when another storage references the same buffer
+    bool shared() const;
+    bool external() const { return !block_ && data_; }
+
+    // Keeps existing elements and zero-fills new ones; only reallocates when
+    // the buffer is shared or its capacity is exceeded
+    void resize(size_t size);
+
+    // Drops this storage's reference to its buffer, leaving it empty
+    void clear();
+
+private:
+    // Header placed in front of every buffer; its size keeps the data on
+    // the allocator's alignment
+    struct alignas(64) Block {
+        std::atomic<size_t> refs;
+        Allocator* allocator;
+        size_t capacity;
+    };
+
+    static Block* allocate_block(Allocator* allocator, size_t capacity);
+    static float* block_data(Block* block) { return reinterpret_cast<float*>(block + 1); }
+
+    bool can_share(const Storage& other) const;
+    void share(const Storage& other);
+    void detach(size_t capacity);
+    void release();
+
+    Allocator* allocator_;
+    Block* block_;
+    float* data_;
+    size_t size_;
+};
+
+} // namespace nn
+
+#endif // STORAGE_H
@@ -7,74 +7,223 @@
 #include <numeric>
 #include <algorithm>
 #include <cmath>
+#include "FastMath.h"
+#include "Gemm.h"
+#include "Shape.h"
+#include "Storage.h"
 
 namespace nn {
 
+template <typename Derived>
+struct TensorExpr;
+
+// Rank-N tensor over a strided view of a Storage buffer. Most tensors are
+// contiguous and row-major; reshape, permute and slice return views that
+// share the buffer without copying. Because storage is copy-on-write, a
+// view still behaves as a value: writing through it detaches it from the
+// tensor it was taken from. Kernels need contiguous data, so operations
+// pack non-contiguous operands first, except matmul, which reads transposed
+// 2-D views in place.
 class Tensor {
 public:
     // Constructors
     Tensor();
-    Tensor(const std::vector<float>& data, const std::vector<size_t>& shape);
+    Tensor(const std::vector<float>& data, const Shape& shape);
     Tensor(const std::vector<std::vector<float>>& data);  // For 2D convenience
     Tensor(size_t rows, size_t cols);  // Initialize with zeros
+    explicit Tensor(const Shape& shape);  // Initialize with zeros
+    Tensor(const Shape& shape, DType dtype);  // Zeros stored as dtype
+
+    // Contiguous tensor over memory owned elsewhere, which must outlive it.
+    // Writes and same-size assignments go to that memory; copies of the
+    // tensor get their own buffer (see Storage::external).
+    static Tensor from_external(float* data, const Shape& shape);
+    static Tensor from_external(void* data, const Shape& shape, DType dtype);
 
-    // Copy constructor and assignment operator
+    // Copies share the underlying buffer; it is duplicated on the first
+    // write through either tensor (see Storage)
     Tensor(const Tensor& other);
     Tensor& operator=(const Tensor& other);
 
-    // Move constructor and assignment operator (for simplicity we'll just copy)
-    Tensor(Tensor&& other) noexcept;
-    Tensor& operator=(Tensor&& other) noexcept;
+    // Moves take over the buffer, but may copy one from a transient
+    // allocator (an Arena) so it cannot outlive its scope (see Storage).
+    // Copying allocates, so they are not noexcept.
+    Tensor(Tensor&& other);
+    Tensor& operator=(Tensor&& other);
+
+    // Evaluate an element-wise expression (see TensorExpr.h) in one pass
+    template <typename E>
+    Tensor(const TensorExpr<E>& e);
+    template <typename E>
+    Tensor& operator=(const TensorExpr<E>& e);
 
     // Destructor
     ~Tensor() = default;
 
-    // Accessors
+    // Accessors. operator[] takes the row-major position of an element,
+    // whatever the layout; at() takes one index per dimension. Element
+    // access and data() need a float32 tensor.
     float& operator()(size_t row, size_t col);
     const float& operator()(size_t row, size_t col) const;
     float& operator[](size_t index);
     const float& operator[](size_t index) const;
+    float& at(std::initializer_list<size_t> index);
+    const float& at(std::initializer_list<size_t> index) const;
 
-    size_t rows() const { return shape_[0]; }
+    size_t rows() const { return shape_.empty() ? 1 : shape_[0]; }
     size_t cols() const { return shape_.size() > 1 ? shape_[1] : 1; }
-    size_t size() const { return data_.size(); }
-    const std::vector<size_t>& shape() const { return shape_; }
-
-    // Basic operations
-    Tensor operator+(const Tensor& other) const;
-    Tensor operator-(const Tensor& other) const;
-    Tensor operator+(float scalar) const;
-    Tensor operator-(float scalar) const;
-    Tensor operator*(const Tensor& other) const;  // Element-wise multiplication
-    Tensor operator*(float scalar) const;
-    Tensor operator/(float scalar) const;
+    size_t size() const { return size_; }
+    size_t rank() const { return shape_.size(); }
+    const Shape& shape() const { return shape_; }
+    const Shape& strides() const { return strides_; }  // In elements
+    bool is_contiguous() const { return contiguous_; }
+
+    // First element of the view; index with strides() unless contiguous
+    float* data() { check_float32(); return data_.data() + offset_; }
+    const float* data() const { check_float32(); return data_.data() + offset_; }
+
+    // Storage type. bfloat16 and float16 tensors halve memory and bandwidth;
+    // operations read them through conversions to float32 and always
+    // produce float32 results (matmul widens them while packing).
+    DType dtype() const { return dtype_; }
+    Tensor to(DType dtype) const;  // Converted copy; shares the buffer if dtype matches
+
+    // First element of the view as stored, for any dtype
+    void* raw_data();
+    const void* raw_data() const;
+    Allocator* allocator() const { return data_.allocator(); }  // Allocator behind the storage
+
+    // Views sharing this tensor's buffer. reshape copies only when the
+    // tensor is not contiguous; permute reorders the dimensions; slice keeps
+    // indices [begin, end) of one dimension.
+    Tensor reshape(const Shape& shape) const;
+    Tensor permute(const Shape& dims) const;
+    Tensor slice(size_t dim, size_t begin, size_t end) const;
+
+    // This tensor when already contiguous, otherwise a packed copy
+    Tensor contiguous() const;
+
+    // Element-wise +, -, * and / are non-member operators returning
+    // expression templates, see TensorExpr.h
+
+    // In-place operations; other may broadcast to this tensor's shape
+    Tensor& add_(const Tensor& other);
+    Tensor& sub_(const Tensor& other);
+    Tensor& mul_(const Tensor& other);
+    Tensor& add_(float scalar);
+    Tensor& mul_(float scalar);
+    Tensor& axpy_(float alpha, const Tensor& x);  // this += alpha * x
+
+    // Reshape to a contiguous tensor of the given shape, reusing the
+    // current buffer when it is large enough
+    void resize(const Shape& shape);  // Keeps the dtype
+    void resize(size_t rows, size_t cols);
+    void resize(const Shape& shape, DType dtype);
+
+    // Drop the data and become an empty 0x0 tensor. A shared buffer stays
+    // with its other owners, which can then write to it without copying.
+    void clear();
 
     // Matrix operations
     Tensor matmul(const Tensor& other) const;
     Tensor transpose() const;
 
     // Activation functions
-    Tensor sigmoid() const;
+    Tensor sigmoid(MathPrecision precision = MathPrecision::Accurate) const;
+    Tensor tanh(MathPrecision precision = MathPrecision::Accurate) const;
     Tensor relu() const;
 
+    // Element-wise transcendental functions
+    Tensor exp(MathPrecision precision = MathPrecision::Accurate) const;
+    Tensor log(MathPrecision precision = MathPrecision::Accurate) const;
+
     // Utility functions
     void fill(float value);
+    // Reductions along axis 0 (down the rows) or 1 (along each row) of a
+    // 2-D tensor, or over all elements with -1. Sums are pairwise and the
+    // results do not depend on the thread count. max and argmax skip NaNs;
+    // argmax returns the index of the first maximum, stored as a float.
     Tensor sum(int axis = -1) const;  // Sum along axis (-1 for all elements)
+    Tensor mean(int axis = -1) const;
+    Tensor max(int axis = -1) const;
+    Tensor argmax(int axis = -1) const;
 
     // Print tensor
     void print() const;
 
 private:
-    std::vector<float> data_;
-    std::vector<size_t> shape_;
-
-    void reshape(const std::vector<size_t>& new_shape);
+    Storage data_;
+    Shape shape_;
+    Shape strides_;
+    size_t offset_ = 0;  // Position of the first element in data_
+    size_t size_ = 0;
+    bool contiguous_ = true;
+    DType dtype_ = DType::Float32;
+
+    void check_float32() const {
+        if (dtype_ != DType::Float32) {
+            throw_not_float32();
+        }
+    }
+    [[noreturn]] void throw_not_float32() const;
+
+    struct ExternalTag {};
+    Tensor(ExternalTag, void* data, const Shape& shape, DType dtype);
+    // Contiguous float32 tensor with uninitialized elements
+    struct UninitializedTag {};
+    Tensor(UninitializedTag, const Shape& shape);
+
+    void set_layout(const Shape& shape, const Shape& strides, size_t offset);
+    void make_contiguous();
     size_t index(size_t row, size_t col) const;
+    size_t linear_index(size_t index) const;
+    size_t element_index(std::initializer_list<size_t> index) const;
 };
 
-// Non-member operators
-Tensor operator*(float scalar, const Tensor& tensor);
+// Row-major strides of a contiguous tensor with the given shape
+Shape contiguous_strides(const Shape& shape);
+
+// NumPy broadcasting: shapes are aligned at their last dimension, missing
+// leading dimensions count as 1, and each pair of dimensions must be equal
+// or contain a 1, which is repeated to match. Throws naming the operation.
+Shape broadcast_shape(const Shape& a, const Shape& b, const char* operation);
+
+// Destination-passing variants of the Tensor operations. dst is resized to
+// the result shape and keeps its buffer, so repeated calls with the same
+// shapes never allocate. Only the element-wise functions accept dst == src.
+// Operands may have any dtype; dst must be float32 except in convert_into.
+// matmul_into computes op(a) * op(b) for 2-D operands, reading transposed
+// operands and transposed views in place.
+void matmul_into(Tensor& dst, const Tensor& a, const Tensor& b,
+                 Transpose trans_a = Transpose::No, Transpose trans_b = Transpose::No);
+// dst = activation(weights * input + bias) for a float32 (rows, 1) bias,
+// with the bias and activation applied by the GEMM epilogue
+void linear_into(Tensor& dst, const Tensor& weights, const Tensor& input, const Tensor& bias,
+                 Activation activation = Activation::Identity,
+                 MathPrecision precision = MathPrecision::Accurate);
+// Backward of linear_into's bias and activation in one pass: grad is
+// grad_output through the activation, found from its output, and
+// grad_bias (rows, 1) is the row sums of grad, equal to sum_into axis 1
+void activation_backward_into(Tensor& grad, Tensor& grad_bias, const Tensor& grad_output,
+                              const Tensor& output, Activation activation);
+// grad alone: grad_output through the activation whose output is output
+void activation_grad_into(Tensor& grad, const Tensor& grad_output, const Tensor& output, Activation activation);
+void transpose_into(Tensor& dst, const Tensor& src);
+void sigmoid_into(Tensor& dst, const Tensor& src, MathPrecision precision = MathPrecision::Accurate);
+void tanh_into(Tensor& dst, const Tensor& src, MathPrecision precision = MathPrecision::Accurate);
+void relu_into(Tensor& dst, const Tensor& src);
+void exp_into(Tensor& dst, const Tensor& src, MathPrecision precision = MathPrecision::Accurate);
+void log_into(Tensor& dst, const Tensor& src, MathPrecision precision = MathPrecision::Accurate);
+// dst becomes a contiguous copy of src stored as dtype, rounding to nearest
+// even when narrowing
+void convert_into(Tensor& dst, const Tensor& src, DType dtype);
+void sum_into(Tensor& dst, const Tensor& src, int axis = -1);
+void mean_into(Tensor& dst, const Tensor& src, int axis = -1);
+void max_into(Tensor& dst, const Tensor& src, int axis = -1);
+void argmax_into(Tensor& dst, const Tensor& src, int axis = -1);
 
 } // namespace nn
 
+#include "TensorExpr.h"
+
 #endif // TENSOR_H
\ No newline at end of file
@@ -0,0 +1,433 @@
+#ifndef TENSOR_EXPR_H
+#define TENSOR_EXPR_H
+
+#include "Tensor.h"
+#include "Kernels.h"
+#include "Scheduler.h"
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace nn {
+
+// Expression templates for element-wise Tensor arithmetic.
+//
+// Operators on tensors return lightweight expression objects that only hold
+// pointers to their operands. Nothing is computed until the expression is
+// assigned to a Tensor, which evaluates the whole tree in a single fused
+// loop. Expressions must therefore not outlive the tensors they reference:
+// assign them to a Tensor rather than storing them with auto.
+//
+// Operands broadcast like NumPy (see broadcast_shape): an (N, 1) column, a
+// (1, M) row or a (1, 1) tensor combines with an (N, M) one. A broadcasting
+// expression is evaluated one row of its last dimension at a time, and a
+// repeated operand is read in place with stride 0 rather than expanded.
+// Non-contiguous and 16-bit operands are packed into float32 when the
+// expression is built.
+
+template <typename Derived>
+struct TensorExpr {
+    const Derived& self() const { return static_cast<const Derived&>(*this); }
+};
+
+// One row of an operand inside a broadcasting expression. step is 0 when
+// the operand repeats one element along the row.
+struct StridedRow {
+    float operator[](size_t j) const { return data[j * step]; }
+
+    const float* data;
+    size_t step;
+};
+
+// Leaf referencing the data of an existing tensor. A non-contiguous view or
+// a 16-bit tensor is packed into a float32 copy the leaf keeps alive, so
+// rows are always dense float32.
+struct TensorOperand : TensorExpr<TensorOperand> {
+    explicit TensorOperand(const Tensor& tensor) {
+        const Tensor* source = &tensor;
+        if (!tensor.is_contiguous() || tensor.dtype() != DType::Float32) {
+            auto packed = std::make_shared<Tensor>();
+            convert_into(*packed, tensor, DType::Float32);
+            packed_ = std::move(packed);
+            source = packed_.get();
+        }
+        data = source->data();
+        shape_ = &source->shape();
+        strides_ = &source->strides();
+        size_ = source->size();
+    }
+
+    float operator[](size_t i) const { return data[i]; }
+    const Shape& shape() const { return *shape_; }
+    size_t size() const { return size_; }
+    bool broadcasts() const { return false; }
+    static constexpr bool is_scalar = false;
+
+    // Row of a broadcast result whose leading dimensions are at index
+    StridedRow row(const Shape& index) const {
+        const size_t rank = shape_->size();
+        const size_t skip = index.size() + 1 - rank;  // Result dimensions this operand lacks
+        size_t offset = 0;
+        for (size_t d = 0; d + 1 < rank; ++d) {
+            if ((*shape_)[d] != 1) {
+                offset += index[skip + d] * (*strides_)[d];
+            }
+        }
+        return {data + offset, rank > 0 && (*shape_)[rank - 1] != 1 ? size_t(1) : size_t(0)};
+    }
+
+    const float* data;
+
+private:
+    std::shared_ptr<const Tensor> packed_;  // Set only when the tensor had to be packed
+    const Shape* shape_;
+    const Shape* strides_;
+    size_t size_;
+};
+
+// Leaf broadcasting a scalar to every element
+struct ScalarOperand : TensorExpr<ScalarOperand> {
+    explicit ScalarOperand(float v) : value(v) {}
+
+    float operator[](size_t) const { return value; }
+    bool broadcasts() const { return false; }
+    ScalarOperand row(const Shape&) const { return *this; }
+    static constexpr bool is_scalar = true;
+
+    float value;
+};
+
+struct AddOp {
+    static float apply(float a, float b) { return a + b; }
+    static constexpr const char* name = "addition";
+};
+
+struct SubOp {
+    static float apply(float a, float b) { return a - b; }
+    static constexpr const char* name = "subtraction";
+};
+
+struct MulOp {
+    static float apply(float a, float b) { return a * b; }
+    static constexpr const char* name = "element-wise multiplication";
+};
+
+template <typename LRow, typename RRow, typename Op>
+struct BinaryRow {
+    float operator[](size_t j) const { return Op::apply(lhs[j], rhs[j]); }
+
+    LRow lhs;
+    RRow rhs;
+};
+
+template <typename L, typename R, typename Op>
+struct BinaryExpr : TensorExpr<BinaryExpr<L, R, Op>> {
+    static_assert(!(L::is_scalar && R::is_scalar), "At least one operand must be a tensor");
+
+    BinaryExpr(const L& l, const R& r) : lhs(l), rhs(r) {
+        if constexpr (!L::is_scalar && !R::is_scalar) {
+            if (lhs.shape() != rhs.shape()) {
+                shape_ = broadcast_shape(lhs.shape(), rhs.shape(), Op::name);
+                broadcast_ = true;
+            }
+        }
+    }
+
+    // Element i in row-major order; only valid when nothing broadcasts
+    float operator[](size_t i) const { return Op::apply(lhs[i], rhs[i]); }
+
+    const Shape& shape() const {
+        if constexpr (L::is_scalar) {
+            return rhs.shape();
+        } else if constexpr (R::is_scalar) {
+            return lhs.shape();
+        } else {
+            return broadcast_ ? shape_ : lhs.shape();
+        }
+    }
+
+    size_t size() const {
+        if constexpr (L::is_scalar) {
+            return rhs.size();
+        } else if constexpr (R::is_scalar) {
+            return lhs.size();
+        } else {
+            return broadcast_ ? shape_.numel() : lhs.size();
+        }
+    }
+
+    // Whether any operand in the tree differs in shape from its sibling
+    bool broadcasts() const { return broadcast_ || lhs.broadcasts() || rhs.broadcasts(); }
+
+    auto row(const Shape& index) const {
+        using LRow = decltype(lhs.row(index));
+        using RRow = decltype(rhs.row(index));
+        return BinaryRow<LRow, RRow, Op>{lhs.row(index), rhs.row(index)};
+    }
+
+    static constexpr bool is_scalar = false;
+
+    L lhs;
+    R rhs;
+
+private:
+    Shape shape_;  // Broadcast result shape
+    bool broadcast_ = false;
+};
+
+template <typename T>
+struct is_tensor_operand
+    : std::integral_constant<bool, std::is_same<T, Tensor>::value ||
+                                   std::is_base_of<TensorExpr<T>, T>::value> {};
+
+inline TensorOperand as_expr(const Tensor& tensor) { return TensorOperand(tensor); }
+
+template <typename E>
+const E& as_expr(const TensorExpr<E>& e) { return e.self(); }
+
+template <typename T>
+using expr_t = typename std::decay<decltype(as_expr(std::declval<const T&>()))>::type;
+
+template <typename L, typename R>
+using enable_if_operands_t =
+    typename std::enable_if<is_tensor_operand<L>::value && is_tensor_operand<R>::value>::type;
+
+template <typename T>
+using enable_if_operand_t = typename std::enable_if<is_tensor_operand<T>::value>::type;
+
+template <typename L, typename R, typename = enable_if_operands_t<L, R>>
+BinaryExpr<expr_t<L>, expr_t<R>, AddOp> operator+(const L& lhs, const R& rhs) {
+    return {as_expr(lhs), as_expr(rhs)};
+}
+
+template <typename L, typename R, typename = enable_if_operands_t<L, R>>
+BinaryExpr<expr_t<L>, expr_t<R>, SubOp> operator-(const L& lhs, const R& rhs) {
+    return {as_expr(lhs), as_expr(rhs)};
+}
+
+template <typename L, typename R, typename = enable_if_operands_t<L, R>>
+BinaryExpr<expr_t<L>, expr_t<R>, MulOp> operator*(const L& lhs, const R& rhs) {
+    return {as_expr(lhs), as_expr(rhs)};
+}
+
+template <typename L, typename = enable_if_operand_t<L>>
+BinaryExpr<expr_t<L>, ScalarOperand, AddOp> operator+(const L& lhs, float scalar) {
+    return {as_expr(lhs), ScalarOperand(scalar)};
+}
+
+template <typename L, typename = enable_if_operand_t<L>>
+BinaryExpr<expr_t<L>, ScalarOperand, SubOp> operator-(const L& lhs, float scalar) {
+    return {as_expr(lhs), ScalarOperand(scalar)};
+}
+
+template <typename L, typename = enable_if_operand_t<L>>
+BinaryExpr<expr_t<L>, ScalarOperand, MulOp> operator*(const L& lhs, float scalar) {
+    return {as_expr(lhs), ScalarOperand(scalar)};
+}
+
+// Multiplies by the reciprocal instead of dividing every element
+template <typename L, typename = enable_if_operand_t<L>>
+BinaryExpr<expr_t<L>, ScalarOperand, MulOp> operator/(const L& lhs, float scalar) {
+    if (scalar == 0.0f) {
+        throw std::runtime_error("Division by zero");
+    }
+    return {as_expr(lhs), ScalarOperand(1.0f / scalar)};
+}
+
+template <typename R, typename = enable_if_operand_t<R>>
+BinaryExpr<ScalarOperand, expr_t<R>, AddOp> operator+(float scalar, const R& rhs) {
+    return {ScalarOperand(scalar), as_expr(rhs)};
+}
+
+template <typename R, typename = enable_if_operand_t<R>>
+BinaryExpr<ScalarOperand, expr_t<R>, SubOp> operator-(float scalar, const R& rhs) {
+    return {ScalarOperand(scalar), as_expr(rhs)};
+}
+
+template <typename R, typename = enable_if_operand_t<R>>
+BinaryExpr<ScalarOperand, expr_t<R>, MulOp> operator*(float scalar, const R& rhs) {
+    return {ScalarOperand(scalar), as_expr(rhs)};
+}
+
+// Calls f(index, out_row, n) for every row of the last dimension of a
+// contiguous result of the given shape, where index holds the positions in
+// the other dimensions. Rows are split across the thread pool.
+template <typename F>
+void for_each_row(const Shape& shape, float* out, F&& f) {
+    const size_t lead = shape.empty() ? 0 : shape.size() - 1;
+    const size_t n = shape.empty() ? 1 : shape[lead];
+    const size_t rows = n == 0 ? 0 : shape.numel() / n;
+    parallel_for(rows, std::max<size_t>(1, ELEMENTWISE_GRAIN / std::max<size_t>(n, 1)), [&](size_t begin, size_t end) {
+        Shape index;
+        for (size_t d = 0; d < lead; ++d) {
+            index.push_back(0);
+        }
+        for (size_t d = lead, r = begin; d-- > 0;) {
+            index[d] = r % shape[d];
+            r /= shape[d];
+        }
+        for (size_t r = begin; r < end; ++r) {
+            f(index, out + r * n, n);
+            for (size_t d = lead; d-- > 0;) {
+                if (++index[d] < shape[d]) {
+                    break;
+                }
+                index[d] = 0;
+            }
+        }
+    });
+}
+
+// Rows of a broadcasting a op b for two tensors, each mapped onto a SIMD
+// kernel; an operand with step 0 is a single value repeated along the row
+inline void broadcast_row(AddOp, StridedRow a, StridedRow b, float* out, size_t n) {
+    const auto& k = kernels::elementwise();
+    if (a.step && b.step) {
+        k.add(a.data, b.data, out, n);
+    } else if (a.step) {
+        k.add_scalar(a.data, *b.data, out, n);
+    } else if (b.step) {
+        k.add_scalar(b.data, *a.data, out, n);
+    } else {
+        k.fill(out, *a.data + *b.data, n);
+    }
+}
+
+inline void broadcast_row(SubOp, StridedRow a, StridedRow b, float* out, size_t n) {
+    const auto& k = kernels::elementwise();
+    if (a.step && b.step) {
+        k.sub(a.data, b.data, out, n);
+    } else if (a.step) {
+        k.add_scalar(a.data, -*b.data, out, n);
+    } else if (b.step) {
+        // a - b rounds exactly like (-b) + a
+        k.mul_scalar(b.data, -1.0f, out, n);
+        k.add_scalar(out, *a.data, out, n);
+    } else {
+        k.fill(out, *a.data - *b.data, n);
+    }
+}
+
+inline void broadcast_row(MulOp, StridedRow a, StridedRow b, float* out, size_t n) {
+    const auto& k = kernels::elementwise();
+    if (a.step && b.step) {
+        k.mul(a.data, b.data, out, n);
+    } else if (a.step) {
+        k.mul_scalar(a.data, *b.data, out, n);
+    } else if (b.step) {
+        k.mul_scalar(b.data, *a.data, out, n);
+    } else {
+        k.fill(out, *a.data * *b.data, n);
+    }
+}
+
+// Fused evaluation of an arbitrary expression tree. Large tensors are
+// split across the thread pool.
+template <typename E>
+void evaluate(const E& e, float* out, size_t n) {
+    if (e.broadcasts()) {
+        for_each_row(e.shape(), out, [&](const Shape& index, float* row_out, size_t width) {
+            const auto row = e.row(index);
+            for (size_t j = 0; j < width; ++j) {
+                row_out[j] = row[j];
+            }
+        });
+        return;
+    }
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            out[i] = e[i];
+        }
+    });
+}
+
+// A single operation maps straight onto the dispatched SIMD kernels
+inline void evaluate(const BinaryExpr<TensorOperand, TensorOperand, AddOp>& e, float* out, size_t n) {
+    if (e.broadcasts()) {
+        for_each_row(e.shape(), out, [&](const Shape& index, float* row_out, size_t width) {
+            broadcast_row(AddOp{}, e.lhs.row(index), e.rhs.row(index), row_out, width);
+        });
+        return;
+    }
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernels::elementwise().add(e.lhs.data + begin, e.rhs.data + begin, out + begin, end - begin);
+    });
+}
+
+inline void evaluate(const BinaryExpr<TensorOperand, TensorOperand, SubOp>& e, float* out, size_t n) {
+    if (e.broadcasts()) {
+        for_each_row(e.shape(), out, [&](const Shape& index, float* row_out, size_t width) {
+            broadcast_row(SubOp{}, e.lhs.row(index), e.rhs.row(index), row_out, width);
+        });
+        return;
+    }
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernels::elementwise().sub(e.lhs.data + begin, e.rhs.data + begin, out + begin, end - begin);
+    });
+}
+
+inline void evaluate(const BinaryExpr<TensorOperand, TensorOperand, MulOp>& e, float* out, size_t n) {
+    if (e.broadcasts()) {
+        for_each_row(e.shape(), out, [&](const Shape& index, float* row_out, size_t width) {
+            broadcast_row(MulOp{}, e.lhs.row(index), e.rhs.row(index), row_out, width);
+        });
+        return;
+    }
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernels::elementwise().mul(e.lhs.data + begin, e.rhs.data + begin, out + begin, end - begin);
+    });
+}
+
+inline void evaluate(const BinaryExpr<TensorOperand, ScalarOperand, AddOp>& e, float* out, size_t n) {
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernels::elementwise().add_scalar(e.lhs.data + begin, e.rhs.value, out + begin, end - begin);
+    });
+}
+
+inline void evaluate(const BinaryExpr<TensorOperand, ScalarOperand, SubOp>& e, float* out, size_t n) {
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernels::elementwise().add_scalar(e.lhs.data + begin, -e.rhs.value, out + begin, end - begin);
+    });
+}
+
+inline void evaluate(const BinaryExpr<TensorOperand, ScalarOperand, MulOp>& e, float* out, size_t n) {
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernels::elementwise().mul_scalar(e.lhs.data + begin, e.rhs.value, out + begin, end - begin);
+    });
+}
+
+inline void evaluate(const BinaryExpr<ScalarOperand, TensorOperand, AddOp>& e, float* out, size_t n) {
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernels::elementwise().add_scalar(e.rhs.data + begin, e.lhs.value, out + begin, end - begin);
+    });
+}
+
+inline void evaluate(const BinaryExpr<ScalarOperand, TensorOperand, MulOp>& e, float* out, size_t n) {
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernels::elementwise().mul_scalar(e.rhs.data + begin, e.lhs.value, out + begin, end - begin);
+    });
+}
+
+// evaluate writes every element, so the buffer is not zeroed first
+template <typename E>
+Tensor::Tensor(const TensorExpr<E>& e)
+    : Tensor(UninitializedTag{}, e.self().shape()) {
+    evaluate(e.self(), data(), size_);
+}
+
+template <typename E>
+Tensor& Tensor::operator=(const TensorExpr<E>& e) {
+    if (shape_ != e.self().shape() || !contiguous_ || data_.shared() || dtype_ != DType::Float32) {
+        // The expression may still read from this tensor's current buffer,
+        // and a shared buffer would be copied only to be overwritten.
+        // Expressions always produce float32.
+        Tensor result(e);
+        return *this = std::move(result);
+    }
+    evaluate(e.self(), data(), size_);
+    return *this;
+}
+
+} // namespace nn
+
+#endif // TENSOR_EXPR_H
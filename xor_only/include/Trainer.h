@@ -0,0 +1,50 @@
+#ifndef TRAINER_H
+#define TRAINER_H
+
+#include "Network.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace nn {
+
+// Mini-batch gradient descent over a dataset stored one sample per column.
+// Each step packs batch_size samples into (features, batch_size) tensors,
+// so the layers run matrix-matrix products instead of one matrix-vector
+// product per sample, and Network::train_step averages the gradients over
+// the batch. The last batch of an epoch holds the remaining samples.
+class Trainer {
+public:
+    explicit Trainer(Network& network, size_t batch_size = 32);
+
+    void set_batch_size(size_t batch_size);
+    size_t get_batch_size() const { return batch_size_; }
+
+    // Visit the samples in a new random order every epoch (off by default)
+    void set_shuffle(bool shuffle, uint32_t seed = 5489u);
+    bool get_shuffle() const { return shuffle_; }
+
+    // One pass over every column of inputs and targets
+    void train_epoch(const Tensor& inputs, const Tensor& targets, float learning_rate);
+    // The same pass minimizing loss; returns its mean over the samples,
+    // each batch measured before its update
+    float train_epoch(const Tensor& inputs, const Tensor& targets, Loss& loss, float learning_rate);
+
+private:
+    float run_epoch(const Tensor& inputs, const Tensor& targets, Loss* loss, float learning_rate);
+
+    Network& network_;
+    size_t batch_size_;
+    bool shuffle_ = false;
+    std::mt19937 gen_;
+    std::vector<size_t> order_;  // Sample visited at each position of the epoch
+    Tensor batch_input_;
+    Tensor batch_target_;
+};
+
+// Packs samples of equal shape (features, 1) into one (features, N) tensor
+Tensor stack_columns(const std::vector<Tensor>& samples);
+
+} // namespace nn
+
+#endif // TRAINER_H
@@ -0,0 +1,147 @@
+#include "Allocator.h"
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace nn {
+
+namespace {
+
+size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+std::atomic<Allocator*> installed_allocator{nullptr};
+thread_local Allocator* thread_allocator = nullptr;
+
+} // namespace
+
+AlignedAllocator::AlignedAllocator(size_t alignment, HugePageMode huge_pages, size_t huge_page_threshold)
+    : alignment_(alignment < alignof(std::max_align_t) ? alignof(std::max_align_t) : alignment),
+      huge_pages_(huge_pages), huge_page_threshold_(huge_page_threshold) {}
+
+void* AlignedAllocator::allocate(size_t bytes) {
+    if (bytes == 0) {
+        return nullptr;
+    }
+
+    void* ptr = nullptr;
+    bool huge = false;
+    HugePageMode mode = huge_pages_.load();
+    if (mode != HugePageMode::Off && bytes >= huge_page_threshold_.load()) {
+        ptr = allocate_huge(bytes, mode, huge);
+    } else {
+        ptr = ::operator new(round_up(bytes, alignment_), std::align_val_t(alignment_));
+    }
+
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    if (huge) {
+        huge_page_allocations_.fetch_add(1, std::memory_order_relaxed);
+    }
+    size_t in_use = bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = peak_bytes_in_use_.load(std::memory_order_relaxed);
+    while (in_use > peak && !peak_bytes_in_use_.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {
+    }
+    return ptr;
+}
+
+void* AlignedAllocator::allocate_huge(size_t bytes, HugePageMode mode, bool& huge) {
+    size_t rounded = round_up(bytes, HUGE_PAGE_SIZE);
+
+#if defined(__linux__)
+    if (mode == HugePageMode::Explicit) {
+        void* mapped = mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapped != MAP_FAILED) {
+            std::lock_guard<std::mutex> lock(large_mutex_);
+            mapped_blocks_.insert(mapped);
+            large_blocks_.fetch_add(1, std::memory_order_release);
+            huge = true;
+            return mapped;
+        }
+    }
+#endif
+
+    // Huge-page aligned so transparent huge pages can back the whole range
+    void* ptr = ::operator new(rounded, std::align_val_t(HUGE_PAGE_SIZE));
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    huge = madvise(ptr, rounded, MADV_HUGEPAGE) == 0;
+#else
+    (void)mode;
+#endif
+    std::lock_guard<std::mutex> lock(large_mutex_);
+    huge_aligned_blocks_.insert(ptr);
+    large_blocks_.fetch_add(1, std::memory_order_release);
+    return ptr;
+}
+
+void AlignedAllocator::deallocate(void* ptr, size_t bytes) {
+    if (!ptr) {
+        return;
+    }
+
+    deallocations_.fetch_add(1, std::memory_order_relaxed);
+    bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+
+    // Only look up the block if huge-page blocks are outstanding
+    if (large_blocks_.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(large_mutex_);
+#if defined(__linux__)
+        if (mapped_blocks_.erase(ptr)) {
+            large_blocks_.fetch_sub(1, std::memory_order_release);
+            munmap(ptr, round_up(bytes, HUGE_PAGE_SIZE));
+            return;
+        }
+#endif
+        if (huge_aligned_blocks_.erase(ptr)) {
+            large_blocks_.fetch_sub(1, std::memory_order_release);
+            ::operator delete(ptr, std::align_val_t(HUGE_PAGE_SIZE));
+            return;
+        }
+    }
+
+    ::operator delete(ptr, std::align_val_t(alignment_));
+}
+
+AllocatorStats AlignedAllocator::stats() const {
+    AllocatorStats stats;
+    stats.allocations = allocations_.load(std::memory_order_relaxed);
+    stats.deallocations = deallocations_.load(std::memory_order_relaxed);
+    stats.bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+    stats.peak_bytes_in_use = peak_bytes_in_use_.load(std::memory_order_relaxed);
+    stats.huge_page_allocations = huge_page_allocations_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AlignedAllocator::set_huge_page_mode(HugePageMode mode, size_t threshold) {
+    huge_page_threshold_.store(threshold);
+    huge_pages_.store(mode);
+}
+
+AlignedAllocator& builtin_allocator() {
+    static AlignedAllocator allocator;
+    return allocator;
+}
+
+Allocator* default_allocator() {
+    Allocator* allocator = installed_allocator.load(std::memory_order_acquire);
+    return allocator ? allocator : &builtin_allocator();
+}
+
+void set_default_allocator(Allocator* allocator) {
+    installed_allocator.store(allocator, std::memory_order_release);
+}
+
+Allocator* current_allocator() {
+    return thread_allocator ? thread_allocator : default_allocator();
+}
+
+Allocator* exchange_thread_allocator(Allocator* allocator) {
+    Allocator* previous = thread_allocator;
+    thread_allocator = allocator;
+    return previous;
+}
+
+} // namespace nn
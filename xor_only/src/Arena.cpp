@@ -0,0 +1,86 @@
+#include "Arena.h"
+#include <algorithm>
+
+namespace nn {
+
+Arena::Arena(size_t chunk_size, Allocator* upstream)
+    : chunk_size_(chunk_size), upstream_(upstream ? upstream : &builtin_allocator()) {}
+
+Arena::~Arena() {
+    for (const Chunk& chunk : chunks_) {
+        upstream_->deallocate(chunk.data, chunk.size);
+    }
+}
+
+void* Arena::allocate(size_t bytes) {
+    if (bytes == 0) {
+        return nullptr;
+    }
+
+    size_t size = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+    // Move on to the next chunk that fits, reserving a new one if none does
+    while (current_ < chunks_.size() && offset_ + size > chunks_[current_].size) {
+        ++current_;
+        offset_ = 0;
+    }
+    if (current_ == chunks_.size()) {
+        size_t chunk_size = std::max(chunk_size_, size);
+        chunks_.push_back({static_cast<char*>(upstream_->allocate(chunk_size)), chunk_size});
+        offset_ = 0;
+    }
+
+    void* ptr = chunks_[current_].data + offset_;
+    offset_ += size;
+
+    stats_.allocations++;
+    stats_.bytes_in_use += size;
+    stats_.peak_bytes_in_use = std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+    return ptr;
+}
+
+void Arena::deallocate(void* ptr, size_t) {
+    if (ptr) {
+        stats_.deallocations++;
+    }
+}
+
+AllocatorStats Arena::stats() const {
+    return stats_;
+}
+
+void Arena::reset() {
+    current_ = 0;
+    offset_ = 0;
+    stats_.bytes_in_use = 0;
+}
+
+size_t Arena::capacity() const {
+    size_t total = 0;
+    for (const Chunk& chunk : chunks_) {
+        total += chunk.size;
+    }
+    return total;
+}
+
+Arena& thread_arena() {
+    thread_local Arena arena;
+    return arena;
+}
+
+ArenaScope::ArenaScope()
+    : ArenaScope(thread_arena()) {}
+
+ArenaScope::ArenaScope(Arena& arena)
+    : arena_(arena), previous_(exchange_thread_allocator(&arena)) {
+    arena_.scope_depth_++;
+}
+
+ArenaScope::~ArenaScope() {
+    exchange_thread_allocator(previous_);
+    if (--arena_.scope_depth_ == 0) {
+        arena_.reset();
+    }
+}
+
+} // namespace nn
@@ -0,0 +1,24 @@
+#include "FastMath.h"
+#include "Kernels.h"
+
+namespace nn {
+namespace math {
+
+void exp(const float* in, float* out, size_t n, MathPrecision precision) {
+    kernels::math(precision).exp(in, out, n);
+}
+
+void log(const float* in, float* out, size_t n, MathPrecision precision) {
+    kernels::math(precision).log(in, out, n);
+}
+
+void sigmoid(const float* in, float* out, size_t n, MathPrecision precision) {
+    kernels::math(precision).sigmoid(in, out, n);
+}
+
+void tanh(const float* in, float* out, size_t n, MathPrecision precision) {
+    kernels::math(precision).tanh(in, out, n);
+}
+
+} // namespace math
+} // namespace nn
@@ -0,0 +1,316 @@
+#include "Gemm.h"
+#include "Kernels.h"
+#include "Scheduler.h"
+#include <algorithm>
+#include <vector>
+
+namespace nn {
+
+namespace {
+
+// Cache blocking: a KC x nr sliver of B stays in L1, an MC x KC block of A
+// stays in L2 and a KC x NC panel of B stays in L3. The register tile (mr x
+// nr) comes from kernels::gemm() and depends on the instruction set.
+constexpr size_t MC = 96;
+constexpr size_t KC = 256;
+constexpr size_t NC = 2048;
+
+// Below this many multiply-adds packing costs more than it saves
+constexpr size_t SMALL_GEMM_FLOPS = 16 * 16 * 16;
+
+// Below this many multiply-adds waking the thread pool costs more than it saves
+constexpr size_t PARALLEL_GEMM_FLOPS = size_t(1) << 20;
+
+// Narrowest row or column strip handed to one task. Every strip packs its
+// own copy of the shared operand, which must stay small next to its compute.
+constexpr size_t MIN_STRIP = 96;
+
+// Packed panels are reused across calls to avoid an allocation per matmul
+thread_local std::vector<float> packed_a;
+thread_local std::vector<float> packed_b;
+
+// Operand element types, widened to float while packing
+struct Bf16Element {
+    uint16_t bits;
+};
+
+struct Fp16Element {
+    uint16_t bits;
+};
+
+inline float widen(const float* p) { return *p; }
+inline float widen(const Bf16Element* p) { return bf16_to_float(p->bits); }
+inline float widen(const Fp16Element* p) { return fp16_to_float(p->bits); }
+
+// GemmEpilogue with the activation resolved to a kernel. The bias is added
+// to the register tile before it is stored; the activation runs over each
+// finished block of C.
+struct TileEpilogue {
+    const float* bias = nullptr;                                 // Value for the first row of C
+    void (*activation)(const float*, float*, size_t) = nullptr;  // Null for the identity
+
+    TileEpilogue rows_from(size_t i) const { return {bias ? bias + i : nullptr, activation}; }
+};
+
+TileEpilogue resolve(const GemmEpilogue& epilogue) {
+    TileEpilogue tile;
+    tile.bias = epilogue.bias;
+    if (epilogue.activation == Activation::Sigmoid) {
+        tile.activation = kernels::math(epilogue.precision).sigmoid;
+    } else if (epilogue.activation == Activation::ReLU) {
+        tile.activation = kernels::elementwise().relu;
+    }
+    return tile;
+}
+
+// Applies the epilogue to finished rows of C, m rows of n
+void apply_epilogue(const TileEpilogue& epilogue, float* C, size_t ldc, size_t m, size_t n) {
+    const auto& elementwise = kernels::elementwise();
+    for (size_t i = 0; i < m; ++i) {
+        float* row = C + i * ldc;
+        if (epilogue.bias) {
+            elementwise.add_scalar(row, epilogue.bias[i], row, n);
+        }
+        if (epilogue.activation) {
+            epilogue.activation(row, row, n);
+        }
+    }
+}
+
+// Pack an mc x kc block of op(A) into slivers of tile_rows rows laid out
+// k-major, padding the last sliver with zeros. A points at element op(A)(0, 0).
+template <typename TA>
+void pack_a(Transpose trans, size_t mc, size_t kc, const TA* A, size_t lda, size_t tile_rows, float* dst) {
+    // Step between consecutive rows and consecutive k of op(A)
+    const size_t row_step = trans == Transpose::Yes ? 1 : lda;
+    const size_t k_step = trans == Transpose::Yes ? lda : 1;
+    for (size_t i = 0; i < mc; i += tile_rows) {
+        size_t mr = std::min(tile_rows, mc - i);
+        for (size_t p = 0; p < kc; ++p) {
+            const TA* src = A + i * row_step + p * k_step;
+            for (size_t r = 0; r < mr; ++r) {
+                dst[r] = widen(src + r * row_step);
+            }
+            for (size_t r = mr; r < tile_rows; ++r) {
+                dst[r] = 0.0f;
+            }
+            dst += tile_rows;
+        }
+    }
+}
+
+// Pack a kc x nc panel of op(B) into slivers of tile_cols columns laid out
+// k-major, padding the last sliver with zeros. B points at element op(B)(0, 0).
+template <typename TB>
+void pack_b(Transpose trans, size_t kc, size_t nc, const TB* B, size_t ldb, size_t tile_cols, float* dst) {
+    // Step between consecutive k and consecutive columns of op(B)
+    const size_t k_step = trans == Transpose::Yes ? 1 : ldb;
+    const size_t col_step = trans == Transpose::Yes ? ldb : 1;
+    for (size_t j = 0; j < nc; j += tile_cols) {
+        size_t nr = std::min(tile_cols, nc - j);
+        for (size_t p = 0; p < kc; ++p) {
+            const TB* src = B + p * k_step + j * col_step;
+            for (size_t c = 0; c < nr; ++c) {
+                dst[c] = widen(src + c * col_step);
+            }
+            for (size_t c = nr; c < tile_cols; ++c) {
+                dst[c] = 0.0f;
+            }
+            dst += tile_cols;
+        }
+    }
+}
+
+// Unpacked i-k-j loop for tiny problems; keeps the same k summation order
+template <typename TA, typename TB>
+void small_gemm(Transpose trans_a, Transpose trans_b,
+                size_t M, size_t N, size_t K,
+                const TA* A, size_t lda,
+                const TB* B, size_t ldb,
+                float* C, size_t ldc, const TileEpilogue& epilogue) {
+    const size_t a_row = trans_a == Transpose::Yes ? 1 : lda;
+    const size_t a_k = trans_a == Transpose::Yes ? lda : 1;
+    const size_t b_k = trans_b == Transpose::Yes ? 1 : ldb;
+    const size_t b_col = trans_b == Transpose::Yes ? ldb : 1;
+    for (size_t i = 0; i < M; ++i) {
+        float* c_row = C + i * ldc;
+        std::fill(c_row, c_row + N, 0.0f);
+        for (size_t k = 0; k < K; ++k) {
+            const float a = widen(A + i * a_row + k * a_k);
+            const TB* b_row = B + k * b_k;
+            if (b_col == 1) {
+                for (size_t j = 0; j < N; ++j) {
+                    c_row[j] += a * widen(b_row + j);
+                }
+            } else {
+                for (size_t j = 0; j < N; ++j) {
+                    c_row[j] += a * widen(b_row + j * b_col);
+                }
+            }
+        }
+        apply_epilogue(epilogue.rows_from(i), c_row, ldc, 1, N);
+    }
+}
+
+// Packed, cache-blocked product for one thread
+template <typename TA, typename TB>
+void blocked_gemm(Transpose trans_a, Transpose trans_b,
+                  size_t M, size_t N, size_t K,
+                  const TA* A, size_t lda,
+                  const TB* B, size_t ldb,
+                  float* C, size_t ldc, const TileEpilogue& epilogue, const kernels::GemmTile& tile) {
+    const size_t tile_rows = tile.mr;
+    const size_t tile_cols = tile.nr;
+    const size_t max_kc = std::min(K, KC);
+    const size_t max_mc = (std::min(M, MC) + tile_rows - 1) / tile_rows * tile_rows;
+    const size_t max_nc = (std::min(N, NC) + tile_cols - 1) / tile_cols * tile_cols;
+    if (packed_a.size() < max_mc * max_kc) {
+        packed_a.resize(max_mc * max_kc);
+    }
+    if (packed_b.size() < max_kc * max_nc) {
+        packed_b.resize(max_kc * max_nc);
+    }
+
+    for (size_t jc = 0; jc < N; jc += NC) {
+        const size_t nc = std::min(NC, N - jc);
+
+        for (size_t pc = 0; pc < K; pc += KC) {
+            const size_t kc = std::min(KC, K - pc);
+            const bool accumulate = pc > 0;
+            const bool last = pc + kc == K;
+            const TB* b_panel = trans_b == Transpose::Yes ? B + jc * ldb + pc : B + pc * ldb + jc;
+            pack_b(trans_b, kc, nc, b_panel, ldb, tile_cols, packed_b.data());
+
+            for (size_t ic = 0; ic < M; ic += MC) {
+                const size_t mc = std::min(MC, M - ic);
+                const TA* a_block = trans_a == Transpose::Yes ? A + pc * lda + ic : A + ic * lda + pc;
+                pack_a(trans_a, mc, kc, a_block, lda, tile_rows, packed_a.data());
+
+                for (size_t jr = 0; jr < nc; jr += tile_cols) {
+                    const size_t nr = std::min(tile_cols, nc - jr);
+                    const float* b_sliver = packed_b.data() + jr * kc;
+
+                    for (size_t ir = 0; ir < mc; ir += tile_rows) {
+                        const size_t mr = std::min(tile_rows, mc - ir);
+                        const float* bias = last && epilogue.bias ? epilogue.bias + ic + ir : nullptr;
+                        tile.kernel(kc, packed_a.data() + ir * kc, b_sliver,
+                                    C + (ic + ir) * ldc + jc + jr, ldc,
+                                    mr, nr, accumulate, bias);
+                    }
+                }
+
+                // The finished mc x nc block of C is still in L2; calling the
+                // activation once per row of it beats once per register tile
+                if (last && epilogue.activation) {
+                    apply_epilogue({nullptr, epilogue.activation}, C + ic * ldc + jc, ldc, mc, nc);
+                }
+            }
+        }
+    }
+}
+
+template <typename TA, typename TB>
+void gemm_impl(Transpose trans_a, Transpose trans_b,
+               size_t M, size_t N, size_t K,
+               const TA* A, size_t lda,
+               const TB* B, size_t ldb,
+               float* C, size_t ldc, const TileEpilogue& epilogue) {
+    if (M == 0 || N == 0) {
+        return;
+    }
+
+    // Includes K == 0, where small_gemm zero-fills C and applies the epilogue
+    if (M * N * K <= SMALL_GEMM_FLOPS) {
+        small_gemm(trans_a, trans_b, M, N, K, A, lda, B, ldb, C, ldc, epilogue);
+        return;
+    }
+
+    const auto& tiles = kernels::gemm();
+    const kernels::GemmTile& tile = N < tiles.wide.nr ? tiles.narrow : tiles.wide;
+
+    // Split the larger of M and N into register-tile aligned strips. Every
+    // element is still computed by exactly one thread in the same order, so
+    // the result does not depend on the thread count.
+    if (M * N * K >= PARALLEL_GEMM_FLOPS) {
+        const size_t tile_rows = tile.mr;
+        const size_t tile_cols = tile.nr;
+        if (M / tile_rows >= N / tile_cols) {
+            parallel_for((M + tile_rows - 1) / tile_rows, MIN_STRIP / tile_rows, [&](size_t begin, size_t end) {
+                const size_t i0 = begin * tile_rows;
+                const size_t i1 = std::min(end * tile_rows, M);
+                const TA* a = trans_a == Transpose::Yes ? A + i0 : A + i0 * lda;
+                blocked_gemm(trans_a, trans_b, i1 - i0, N, K, a, lda, B, ldb, C + i0 * ldc, ldc,
+                             epilogue.rows_from(i0), tile);
+            });
+        } else {
+            parallel_for((N + tile_cols - 1) / tile_cols, MIN_STRIP / tile_cols, [&](size_t begin, size_t end) {
+                const size_t j0 = begin * tile_cols;
+                const size_t j1 = std::min(end * tile_cols, N);
+                const TB* b = trans_b == Transpose::Yes ? B + j0 * ldb : B + j0;
+                blocked_gemm(trans_a, trans_b, M, j1 - j0, K, A, lda, b, ldb, C + j0, ldc, epilogue, tile);
+            });
+        }
+        return;
+    }
+
+    blocked_gemm(trans_a, trans_b, M, N, K, A, lda, B, ldb, C, ldc, epilogue, tile);
+}
+
+// Picks the element type of B for gemm
+template <typename TA>
+void gemm_b(Transpose trans_a, Transpose trans_b,
+            size_t M, size_t N, size_t K,
+            const TA* A, size_t lda,
+            const void* B, DType b_type, size_t ldb,
+            float* C, size_t ldc, const TileEpilogue& epilogue) {
+    switch (b_type) {
+        case DType::Float32:
+            gemm_impl(trans_a, trans_b, M, N, K, A, lda, static_cast<const float*>(B), ldb, C, ldc, epilogue);
+            break;
+        case DType::BFloat16:
+            gemm_impl(trans_a, trans_b, M, N, K, A, lda, static_cast<const Bf16Element*>(B), ldb, C, ldc, epilogue);
+            break;
+        case DType::Float16:
+            gemm_impl(trans_a, trans_b, M, N, K, A, lda, static_cast<const Fp16Element*>(B), ldb, C, ldc, epilogue);
+            break;
+    }
+}
+
+} // namespace
+
+void sgemm(size_t M, size_t N, size_t K,
+           const float* A, size_t lda,
+           const float* B, size_t ldb,
+           float* C, size_t ldc) {
+    sgemm(Transpose::No, Transpose::No, M, N, K, A, lda, B, ldb, C, ldc);
+}
+
+void sgemm(Transpose trans_a, Transpose trans_b,
+           size_t M, size_t N, size_t K,
+           const float* A, size_t lda,
+           const float* B, size_t ldb,
+           float* C, size_t ldc) {
+    gemm_impl(trans_a, trans_b, M, N, K, A, lda, B, ldb, C, ldc, TileEpilogue());
+}
+
+void gemm(Transpose trans_a, Transpose trans_b,
+          size_t M, size_t N, size_t K,
+          const void* A, DType a_type, size_t lda,
+          const void* B, DType b_type, size_t ldb,
+          float* C, size_t ldc,
+          const GemmEpilogue& epilogue) {
+    const TileEpilogue tile = resolve(epilogue);
+    switch (a_type) {
+        case DType::Float32:
+            gemm_b(trans_a, trans_b, M, N, K, static_cast<const float*>(A), lda, B, b_type, ldb, C, ldc, tile);
+            break;
+        case DType::BFloat16:
+            gemm_b(trans_a, trans_b, M, N, K, static_cast<const Bf16Element*>(A), lda, B, b_type, ldb, C, ldc, tile);
+            break;
+        case DType::Float16:
+            gemm_b(trans_a, trans_b, M, N, K, static_cast<const Fp16Element*>(A), lda, B, b_type, ldb, C, ldc, tile);
+            break;
+    }
+}
+
+} // namespace nn
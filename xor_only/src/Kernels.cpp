@@ -0,0 +1,237 @@
+#include "Kernels.h"
+#include "kernels/Tables.h"
+#include <cstdlib>
+#if defined(NN_X86_KERNELS)
+#include <cpuid.h>
+#endif
+#include <stdexcept>
+#include <string>
+
+namespace nn {
+namespace kernels {
+
+namespace {
+
+Isa select_isa() {
+    Isa isa = detect_isa();
+
+    // NN_ISA can only lower the selection, never enable unsupported code
+    if (const char* env = std::getenv("NN_ISA")) {
+        const std::string requested(env);
+        for (Isa candidate : {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512}) {
+            if (requested == isa_name(candidate) && isa_supported(candidate)) {
+                isa = candidate;
+            }
+        }
+    }
+    return isa;
+}
+
+} // namespace
+
+Isa detect_isa() {
+#if defined(NN_X86_KERNELS)
+    __builtin_cpu_init();
+    // The AVX2 and AVX-512 variants also use F16C, which libgcc cannot query
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    const bool f16c = __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_F16C);
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && f16c) {
+        return Isa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && f16c) {
+        return Isa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return Isa::SSE2;
+    }
+#endif
+    return Isa::Scalar;
+}
+
+Isa active_isa() {
+    static const Isa isa = select_isa();
+    return isa;
+}
+
+bool isa_supported(Isa isa) {
+    return static_cast<int>(isa) <= static_cast<int>(detect_isa());
+}
+
+const char* isa_name(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar: return "scalar";
+        case Isa::SSE2: return "sse2";
+        case Isa::AVX2: return "avx2";
+        case Isa::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+const ElementwiseKernels& elementwise() {
+    static const ElementwiseKernels& table = elementwise(active_isa());
+    return table;
+}
+
+const ElementwiseKernels& elementwise(Isa isa) {
+    if (!isa_supported(isa)) {
+        throw std::runtime_error(std::string("Instruction set not supported: ") + isa_name(isa));
+    }
+
+    switch (isa) {
+#if defined(NN_X86_KERNELS)
+        case Isa::AVX512: return avx512::elementwise_table;
+        case Isa::AVX2: return avx2::elementwise_table;
+        case Isa::SSE2: return sse2::elementwise_table;
+#endif
+        default: return scalar::elementwise_table;
+    }
+}
+
+const ReductionKernels& reductions() {
+    static const ReductionKernels& table = reductions(active_isa());
+    return table;
+}
+
+const ReductionKernels& reductions(Isa isa) {
+    if (!isa_supported(isa)) {
+        throw std::runtime_error(std::string("Instruction set not supported: ") + isa_name(isa));
+    }
+
+    switch (isa) {
+#if defined(NN_X86_KERNELS)
+        case Isa::AVX512: return avx512::reduction_table;
+        case Isa::AVX2: return avx2::reduction_table;
+        case Isa::SSE2: return sse2::reduction_table;
+#endif
+        default: return scalar::reduction_table;
+    }
+}
+
+const ConversionKernels& conversions() {
+    static const ConversionKernels& table = conversions(active_isa());
+    return table;
+}
+
+const ConversionKernels& conversions(Isa isa) {
+    if (!isa_supported(isa)) {
+        throw std::runtime_error(std::string("Instruction set not supported: ") + isa_name(isa));
+    }
+
+    switch (isa) {
+#if defined(NN_X86_KERNELS)
+        case Isa::AVX512: return avx512::conversion_table;
+        case Isa::AVX2: return avx2::conversion_table;
+        case Isa::SSE2: return sse2::conversion_table;
+#endif
+        default: return scalar::conversion_table;
+    }
+}
+
+const QuantizedKernels& quantized() {
+    static const QuantizedKernels& table = quantized(active_isa());
+    return table;
+}
+
+const QuantizedKernels& quantized(Isa isa) {
+    if (!isa_supported(isa)) {
+        throw std::runtime_error(std::string("Instruction set not supported: ") + isa_name(isa));
+    }
+
+    switch (isa) {
+#if defined(NN_X86_KERNELS)
+        case Isa::AVX512: {
+            unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+            const bool vnni = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ecx & bit_AVX512VNNI);
+            return vnni ? avx512::quantized_vnni_table : avx512::quantized_table;
+        }
+        case Isa::AVX2: return avx2::quantized_table;
+        case Isa::SSE2: return sse2::quantized_table;
+#endif
+        default: return scalar::quantized_table;
+    }
+}
+
+const SparseKernels& sparse() {
+    static const SparseKernels& table = sparse(active_isa());
+    return table;
+}
+
+const SparseKernels& sparse(Isa isa) {
+    if (!isa_supported(isa)) {
+        throw std::runtime_error(std::string("Instruction set not supported: ") + isa_name(isa));
+    }
+
+    switch (isa) {
+#if defined(NN_X86_KERNELS)
+        case Isa::AVX512: return avx512::sparse_table;
+        case Isa::AVX2: return avx2::sparse_table;
+        case Isa::SSE2: return sse2::sparse_table;
+#endif
+        default: return scalar::sparse_table;
+    }
+}
+
+const GemmKernels& gemm() {
+    static const GemmKernels& table = gemm(active_isa());
+    return table;
+}
+
+const GemmKernels& gemm(Isa isa) {
+    if (!isa_supported(isa)) {
+        throw std::runtime_error(std::string("Instruction set not supported: ") + isa_name(isa));
+    }
+
+    switch (isa) {
+#if defined(NN_X86_KERNELS)
+        case Isa::AVX512: return avx512::gemm_table;
+        case Isa::AVX2: return avx2::gemm_table;
+        case Isa::SSE2: return sse2::gemm_table;
+#endif
+        default: return scalar::gemm_table;
+    }
+}
+
+const OptimizerKernels& optimizer() {
+    static const OptimizerKernels& table = optimizer(active_isa());
+    return table;
+}
+
+const OptimizerKernels& optimizer(Isa isa) {
+    if (!isa_supported(isa)) {
+        throw std::runtime_error(std::string("Instruction set not supported: ") + isa_name(isa));
+    }
+
+    switch (isa) {
+#if defined(NN_X86_KERNELS)
+        case Isa::AVX512: return avx512::optimizer_table;
+        case Isa::AVX2: return avx2::optimizer_table;
+        case Isa::SSE2: return sse2::optimizer_table;
+#endif
+        default: return scalar::optimizer_table;
+    }
+}
+
+const MathKernels& math(MathPrecision precision) {
+    static const MathKernels& accurate = math(active_isa(), MathPrecision::Accurate);
+    static const MathKernels& fast = math(active_isa(), MathPrecision::Fast);
+    return precision == MathPrecision::Fast ? fast : accurate;
+}
+
+const MathKernels& math(Isa isa, MathPrecision precision) {
+    if (!isa_supported(isa)) {
+        throw std::runtime_error(std::string("Instruction set not supported: ") + isa_name(isa));
+    }
+
+    const bool fast = precision == MathPrecision::Fast;
+    switch (isa) {
+#if defined(NN_X86_KERNELS)
+        case Isa::AVX512: return fast ? avx512::math_fast_table : avx512::math_accurate_table;
+        case Isa::AVX2: return fast ? avx2::math_fast_table : avx2::math_accurate_table;
+        case Isa::SSE2: return fast ? sse2::math_fast_table : sse2::math_accurate_table;
+#endif
+        default: return fast ? scalar::math_fast_table : scalar::math_accurate_table;
+    }
+}
+
+} // namespace kernels
+} // namespace nn
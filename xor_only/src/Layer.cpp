@@ -1,10 +1,35 @@
 #include "Layer.h"
+#include "Kernels.h"
+#include "Scheduler.h"
 #include <random>
+#include <stdexcept>
 
 namespace nn {
 
-Linear::Linear(size_t input_size, size_t output_size) 
-    : weights_(output_size, input_size), bias_(output_size, 1), 
+namespace {
+
+// Largest fraction of stored weights for which the sparse product is used.
+// The SIMD sparse kernels beat the dense GEMM up to about this density;
+// the scalar one only below about 20%.
+constexpr float SPARSE_MAX_DENSITY = 0.5f;
+
+// Multiply-adds in the weight gradient above which it runs as a separate
+// task alongside the input gradient
+constexpr size_t PARALLEL_BACKWARD_FLOPS = size_t(1) << 18;
+
+// Activation in place, for the paths that have no GEMM epilogue
+void activate(Tensor& t, Activation activation, MathPrecision precision) {
+    if (activation == Activation::Sigmoid) {
+        sigmoid_into(t, t, precision);
+    } else if (activation == Activation::ReLU) {
+        relu_into(t, t);
+    }
+}
+
+} // namespace
+
+Linear::Linear(size_t input_size, size_t output_size, Activation activation)
+    : activation_(activation), weights_(output_size, input_size), bias_(output_size, 1), 
       grad_weights_(output_size, input_size), grad_bias_(output_size, 1) {
     // Initialize weights randomly
     std::random_device rd;
@@ -20,47 +45,147 @@ Linear::Linear(size_t input_size, size_t output_size)
     }
 }
 
-Tensor Linear::forward(const Tensor& input) {
-    // Store input for backward pass
-    input_cache_ = input;
+Linear::Linear(Tensor weights, Tensor bias)
+    : storage_type_(weights.dtype()), weights_(std::move(weights)), bias_(std::move(bias)) {
+    if (weights_.rank() != 2 || bias_.shape() != Shape{weights_.rows(), 1}) {
+        throw std::runtime_error("Linear expects (outputs, inputs) weights and an (outputs, 1) bias");
+    }
+    if (bias_.dtype() != DType::Float32) {
+        bias_ = bias_.to(DType::Float32);
+    }
+    // Gradients are allocated by the first backward
+}
+
+const Tensor& Linear::forward(const Tensor& input) {
+    if (is_quantized()) {
+        // Inference only, so nothing is cached
+        quantized_linear_into(output_, quantized_weights_, input, input_quantization_, bias_);
+        activate(output_, activation_, precision_);
+        return output_;
+    }
     
-    // Compute: output = weights * input + bias
-    Tensor weighted_sum = weights_.matmul(input);
+    // Store input for backward pass; shares the buffer rather than copying
+    // it, unless it is narrowed to the storage type
+    if (storage_type_ == DType::Float32) {
+        input_cache_ = input;
+    } else {
+        convert_into(input_cache_, input, storage_type_);
+    }
     
-    // Add bias (broadcasting: bias is (output_size, 1), weighted_sum is (output_size, batch_size))
-    Tensor output(weighted_sum.rows(), weighted_sum.cols());
-    for (size_t i = 0; i < weighted_sum.rows(); ++i) {
-        for (size_t j = 0; j < weighted_sum.cols(); ++j) {
-            output(i, j) = weighted_sum(i, j) + bias_(i, 0);
-        }
+    // Compute: output = activation(weights * input + bias)
+    if (is_sparse()) {
+        sparse_matmul_into(output_, sparse_weights_, input);
+        // Add bias, broadcasting its (output_size, 1) column over the batch
+        output_.add_(bias_);
+        activate(output_, activation_, precision_);
+    } else {
+        // The bias and activation are applied to each tile as the GEMM finishes it
+        linear_into(output_, weights_, input, bias_, activation_, precision_);
     }
     
-    return output;
+    return output_;
+}
+
+void Linear::infer(const Tensor& input, Tensor& output) {
+    if (is_quantized()) {
+        quantized_linear_into(output, quantized_weights_, input, input_quantization_, bias_);
+        activate(output, activation_, precision_);
+    } else if (is_sparse()) {
+        sparse_matmul_into(output, sparse_weights_, input);
+        output.add_(bias_);
+        activate(output, activation_, precision_);
+    } else {
+        linear_into(output, weights_, input, bias_, activation_, precision_);
+    }
 }
 
-Tensor Linear::backward(const Tensor& grad_output) {
-    // Compute gradients
-    // grad_weights = grad_output * input^T
-    grad_weights_ = grad_output.matmul(input_cache_.transpose());
+const Tensor& Linear::backward(const Tensor& grad_output) {
+    if (is_quantized()) {
+        throw std::runtime_error("Quantized Linear layers are inference-only; call dequantize() before training");
+    }
     
-    // grad_bias = sum(grad_output, axis=1) (sum along batch dimension)
-    grad_bias_ = grad_output.sum(1);  // Sum along columns to get (output_size, 1)
+    // grad = grad_output through the activation, read back from the output,
+    // and grad_bias = sum(grad, axis=1) (sum along batch dimension)
+    const Tensor* grad = &grad_output;
+    if (activation_ == Activation::Identity) {
+        sum_into(grad_bias_, grad_output, 1);  // Sum along columns to get (output_size, 1)
+    } else {
+        activation_backward_into(grad_pre_activation_, grad_bias_, grad_output, output_, activation_);
+        grad = &grad_pre_activation_;
+    }
+    
+    // Compute gradients; transposed operands are read in place by the GEMM
+    // grad_weights = grad * input^T
+    auto weight_gradient = [&] {
+        matmul_into(grad_weights_, *grad, input_cache_, Transpose::No, Transpose::Yes);
+    };
+    
+    // The gradients are independent, so for large layers the weight
+    // gradient runs as a task while this thread computes the input gradient
+    TaskGroup group;
+    if (grad->size() * input_cache_.rows() >= PARALLEL_BACKWARD_FLOPS) {
+        group.run(weight_gradient);
+    } else {
+        weight_gradient();
+    }
     
-    // grad_input = weights^T * grad_output
-    Tensor grad_input = weights_.transpose().matmul(grad_output);
+    // grad_input = weights^T * grad
+    matmul_into(grad_input_, weights_, *grad, Transpose::Yes, Transpose::No);
     
-    return grad_input;
+    group.wait();
+    return grad_input_;
 }
 
 void Linear::update_parameters(float learning_rate) {
-    // Update weights: weights = weights - learning_rate * grad_weights
-    for (size_t i = 0; i < weights_.size(); ++i) {
-        weights_[i] -= learning_rate * grad_weights_[i];
+    // weights -= learning_rate * grad_weights, bias -= learning_rate * grad_bias
+    weights_.axpy_(-learning_rate, grad_weights_);
+    bias_.axpy_(-learning_rate, grad_bias_);
+    parameters_updated();
+}
+
+void Linear::parameters_updated() {
+    if (is_sparse()) {
+        // Pruned weights stay zero
+        sparse_weights_.refresh(weights_);
     }
-    
-    // Update bias: bias = bias - learning_rate * grad_bias
-    for (size_t i = 0; i < bias_.size(); ++i) {
-        bias_[i] -= learning_rate * grad_bias_[i];
+}
+
+void Linear::prune(float sparsity, SparseFormat format) {
+    magnitude_prune({&weights_}, sparsity, format == SparseFormat::Blocked ? kernels::SPARSE_BLOCK_ROWS : 1);
+    update_sparse_weights(format);
+}
+
+void Linear::update_sparse_weights(SparseFormat format) {
+    SparseMatrix sparse(weights_, format);
+    sparse_weights_ = sparse.density() <= SPARSE_MAX_DENSITY ? std::move(sparse) : SparseMatrix();
+}
+
+void Linear::clear_cache() {
+    // A narrowed cache owns its buffer and is kept for the next step
+    if (storage_type_ == DType::Float32) {
+        input_cache_.clear();
+    }
+}
+
+void Linear::quantize(const Tensor& calibration_input) {
+    quantize(ActivationQuantization::calibrate(calibration_input));
+}
+
+void Linear::quantize(const ActivationQuantization& input) {
+    input_quantization_ = input;
+    quantized_weights_ = QuantizedMatrix(weights_);
+    input_cache_.clear();
+}
+
+void Linear::set_storage_type(DType dtype) {
+    if (dtype == storage_type_) {
+        return;
+    }
+    storage_type_ = dtype;
+    convert_into(weights_, weights_, dtype);
+    input_cache_.clear();
+    if (is_sparse()) {
+        sparse_weights_.refresh(weights_);  // Take the rounded values
     }
 }
 
@@ -74,7 +199,13 @@ std::vector<Tensor*> Linear::get_gradients() {
 
 void Linear::set_weights(const Tensor& weights) {
     if (weights.shape() == weights_.shape()) {
-        weights_ = weights;
+        weights_ = weights.to(storage_type_);
+        if (is_sparse()) {
+            update_sparse_weights(sparse_weights_.format());
+        }
+        if (is_quantized()) {
+            quantized_weights_ = QuantizedMatrix(weights_);
+        }
     }
 }
 
@@ -84,18 +215,26 @@ void Linear::set_bias(const Tensor& bias) {
     }
 }
 
-Tensor Sigmoid::forward(const Tensor& input) {
-    Tensor output = input.sigmoid();
-    output_cache_ = output;  // Store for backward pass
-    return output;
+const Tensor& Sigmoid::forward(const Tensor& input) {
+    sigmoid_into(output_cache_, input, precision_);  // Store for backward pass
+    return output_cache_;
+}
+
+const Tensor& Sigmoid::backward(const Tensor& grad_output) {
+    // Derivative of sigmoid: sigmoid(x) * (1 - sigmoid(x)), fused into one pass
+    grad_input_ = grad_output * (output_cache_ * (1.0f - output_cache_));
+    return grad_input_;
+}
+
+const Tensor& ReLU::forward(const Tensor& input) {
+    relu_into(output_cache_, input);  // Store for backward pass
+    return output_cache_;
 }
 
-Tensor Sigmoid::backward(const Tensor& grad_output) {
-    // Derivative of sigmoid: sigmoid(x) * (1 - sigmoid(x))
-    Tensor one_tensor(output_cache_.rows(), output_cache_.cols());
-    one_tensor.fill(1.0f);
-    Tensor sig_derivative = output_cache_ * (one_tensor - output_cache_);  // sig * (1 - sig)
-    return grad_output * sig_derivative;
+const Tensor& ReLU::backward(const Tensor& grad_output) {
+    // The gradient passes where the output is positive
+    activation_grad_into(grad_input_, grad_output, output_cache_, Activation::ReLU);
+    return grad_input_;
 }
 
-} // namespace nn
\ No newline at end of file
+} // namespace nn
@@ -17,19 +17,47 @@ float MSELoss::compute(const Tensor& predicted, const Tensor& actual) {
 }
 
 Tensor MSELoss::compute_gradient(const Tensor& predicted, const Tensor& actual) {
+    Tensor gradient;
+    compute_gradient_into(gradient, predicted, actual);
+    return gradient;
+}
+
+void MSELoss::compute_gradient_into(Tensor& gradient, const Tensor& predicted, const Tensor& actual) {
     if (predicted.shape() != actual.shape()) {
         throw std::runtime_error("Predicted and actual tensor shapes do not match");
     }
     
     // For MSE: d/dx [(x - t)^2] = 2 * (x - t) / n
     size_t n = predicted.size();
-    Tensor gradient(predicted.shape()[0], predicted.shape()[1]);
+    gradient.resize(predicted.shape());
     
     for (size_t i = 0; i < predicted.size(); ++i) {
         gradient[i] = 2.0f * (predicted[i] - actual[i]) / n;
     }
+}
+
+float MSELoss::compute_with_gradient(Tensor& gradient, const Tensor& predicted, const Tensor& actual) {
+    if (predicted.shape() != actual.shape()) {
+        throw std::runtime_error("Predicted and actual tensor shapes do not match");
+    }
     
-    return gradient;
+    // One pass over both operands, summing in the same order as compute
+    const Tensor p = predicted.to(DType::Float32).contiguous();
+    const Tensor t = actual.to(DType::Float32).contiguous();
+    size_t n = p.size();
+    gradient.resize(p.shape(), DType::Float32);
+    
+    const float* x = p.data();
+    const float* y = t.data();
+    float* g = gradient.data();
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        float diff = x[i] - y[i];
+        sum += diff * diff;
+        g[i] = 2.0f * diff / n;
+    }
+    
+    return sum / n;
 }
 
-} // namespace nn
\ No newline at end of file
+} // namespace nn
@@ -0,0 +1,66 @@
+#include "ModelFile.h"
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NN_HAVE_MMAP
+#endif
+
+namespace nn {
+
+MappedFile::MappedFile(const std::string& path) {
+#if defined(NN_HAVE_MMAP)
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open model file: " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot read model file: " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        void* memory = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (memory == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map model file: " + path);
+        }
+        data_ = static_cast<char*>(memory);
+        mapped_ = true;
+    }
+    // The mapping keeps the file alive
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        throw std::runtime_error("Cannot open model file: " + path);
+    }
+    size_ = static_cast<size_t>(in.tellg());
+    in.seekg(0);
+    // Over-allocate so the data can start on a MODEL_ALIGNMENT boundary
+    char* buffer = new char[size_ + MODEL_ALIGNMENT];
+    data_ = buffer + (MODEL_ALIGNMENT - reinterpret_cast<uintptr_t>(buffer) % MODEL_ALIGNMENT) % MODEL_ALIGNMENT;
+    buffer_ = buffer;
+    if (!in.read(data_, static_cast<std::streamsize>(size_))) {
+        delete[] buffer;
+        throw std::runtime_error("Cannot read model file: " + path);
+    }
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if defined(NN_HAVE_MMAP)
+    if (mapped_) {
+        ::munmap(data_, size_);
+    }
+#else
+    delete[] buffer_;
+#endif
+}
+
+} // namespace nn
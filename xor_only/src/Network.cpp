@@ -1,8 +1,109 @@
 #include "Network.h"
+#include "Arena.h"
+#include "ModelFile.h"
+#include "Scheduler.h"
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
 
 namespace nn {
 
+namespace {
+
+// Layers with fewer parameters update inline; queuing a task would cost more
+constexpr size_t PARALLEL_UPDATE_PARAMETERS = ELEMENTWISE_GRAIN;
+
+size_t align_up(size_t offset) {
+    return (offset + MODEL_ALIGNMENT - 1) / MODEL_ALIGNMENT * MODEL_ALIGNMENT;
+}
+
+// Checked view of the part of a model file at offset
+template <typename T>
+const T& model_record(MappedFile& file, size_t offset) {
+    if (offset > file.size() || file.size() - offset < sizeof(T)) {
+        throw std::runtime_error("Model file is truncated");
+    }
+    return *reinterpret_cast<const T*>(file.data() + offset);
+}
+
+// Tensor over the section of file described by record
+Tensor model_tensor(MappedFile& file, const TensorRecord& record) {
+    if (record.dtype > static_cast<uint32_t>(DType::Float16) || record.rank == 0 ||
+        record.rank > Shape::MAX_RANK) {
+        throw std::runtime_error("Model file has an invalid tensor record");
+    }
+    const DType dtype = static_cast<DType>(record.dtype);
+    Shape shape;
+    uint64_t bytes = dtype_size(dtype);
+    for (uint32_t i = 0; i < record.rank; ++i) {
+        const uint64_t dim = record.shape[i];
+        if (dim != 0 && bytes > std::numeric_limits<uint64_t>::max() / dim) {
+            throw std::runtime_error("Model file has an invalid tensor record");
+        }
+        bytes *= dim;
+        shape.push_back(static_cast<size_t>(dim));
+    }
+    if (record.bytes != bytes || record.offset % MODEL_ALIGNMENT != 0 || record.offset > file.size() ||
+        file.size() - record.offset < bytes) {
+        throw std::runtime_error("Model file has a tensor outside the file");
+    }
+    return Tensor::from_external(file.data() + record.offset, shape, dtype);
+}
+
+// Layer of the given type_name() built from its saved parameters
+Layer* make_layer(const std::string& type, const LayerRecord& record, std::vector<Tensor>& tensors) {
+    auto expect = [&](size_t count) {
+        if (tensors.size() != count) {
+            throw std::runtime_error("Model file has the wrong number of tensors for a " + type + " layer");
+        }
+    };
+    if (type == "Linear") {
+        expect(2);
+        if (record.activation > static_cast<uint32_t>(Activation::ReLU)) {
+            throw std::runtime_error("Model file has an unknown activation");
+        }
+        auto* linear = new Linear(std::move(tensors[0]), std::move(tensors[1]));
+        linear->set_activation(static_cast<Activation>(record.activation));
+        return linear;
+    }
+    if (type == "Sigmoid") {
+        expect(0);
+        return new Sigmoid();
+    }
+    if (type == "ReLU") {
+        expect(0);
+        return new ReLU();
+    }
+    throw std::runtime_error("Model file has an unknown layer type: " + type);
+}
+
+// Folds layer into the layer before it where that gives the same results
+// and gradients; returns whether layer became redundant
+bool fuse(Layer* previous, Layer* layer) {
+    auto* sigmoid = dynamic_cast<Sigmoid*>(layer);
+    const bool relu = dynamic_cast<ReLU*>(layer) != nullptr;
+    if (!previous || (!sigmoid && !relu)) {
+        return false;
+    }
+    if (auto* linear = dynamic_cast<Linear*>(previous)) {
+        if (linear->get_activation() == Activation::Identity) {
+            linear->set_activation(sigmoid ? Activation::Sigmoid : Activation::ReLU);
+            if (sigmoid) {
+                linear->set_math_precision(sigmoid->get_math_precision());
+            }
+            return true;
+        }
+        // relu(relu(x)) == relu(x), and the gradient passes through both or neither
+        return relu && linear->get_activation() == Activation::ReLU;
+    }
+    return relu && dynamic_cast<ReLU*>(previous);
+}
+
+} // namespace
+
 Network::Network() {}
 
 Network::~Network() {
@@ -13,39 +114,280 @@ Network::~Network() {
 }
 
 void Network::add_layer(Layer* layer) {
+    layer->set_math_precision(math_precision_);
+    layer->set_storage_type(storage_type_);
     layers_.push_back(layer);
 }
 
-Tensor Network::forward(const Tensor& input) {
-    Tensor current_input = input;
+void Network::compile() {
+    std::vector<Layer*> compiled;
+    for (auto* layer : layers_) {
+        if (fuse(compiled.empty() ? nullptr : compiled.back(), layer)) {
+            delete layer;
+        } else {
+            compiled.push_back(layer);
+        }
+    }
+    layers_ = std::move(compiled);
+    updates_.clear();
+}
+
+void Network::set_math_precision(MathPrecision precision) {
+    math_precision_ = precision;
+    for (auto* layer : layers_) {
+        layer->set_math_precision(precision);
+    }
+}
+
+void Network::set_storage_type(DType dtype) {
+    storage_type_ = dtype;
+    for (auto* layer : layers_) {
+        layer->set_storage_type(dtype);
+    }
+}
+
+const Tensor& Network::predict(const Tensor& input) {
+    // Temporaries created by the layers live in the thread's arena; the
+    // activation buffers were created with the network, so they stay on the heap
+    std::optional<ArenaScope> scope;
+    if (use_arena_) {
+        scope.emplace();
+    }
+    const Tensor* current_input = &input;
     
+    // Start with the buffer the input is not in, which matters when it is
+    // the result of the previous call
+    size_t next = &input == &activations_[0] ? 1 : 0;
     for (auto* layer : layers_) {
-        current_input = layer->forward(current_input);
+        layer->infer(*current_input, activations_[next]);
+        current_input = &activations_[next];
+        next ^= 1;
     }
     
-    return current_input;
+    return *current_input;
+}
+
+void Network::quantize(const Tensor& calibration_input) {
+    // Later layers calibrate on the output of the already quantized ones,
+    // so their ranges include the error introduced before them
+    const Tensor* current_input = &calibration_input;
+    for (auto* layer : layers_) {
+        layer->quantize(*current_input);
+        current_input = &layer->forward(*current_input);
+    }
+    for (auto* layer : layers_) {
+        layer->clear_cache();
+    }
+    quantized_ = true;
+}
+
+void Network::dequantize() {
+    for (auto* layer : layers_) {
+        layer->dequantize();
+    }
+    quantized_ = false;
 }
 
 void Network::train_step(const Tensor& input, const Tensor& target, float learning_rate) {
-    // Forward pass - store outputs for backward pass
-    layer_outputs_.clear();
-    Tensor current_input = input;
-    layer_outputs_.push_back(current_input);
+    step(input, target, nullptr, learning_rate);
+}
+
+float Network::train_step(const Tensor& input, const Tensor& target, Loss& loss, float learning_rate) {
+    return step(input, target, &loss, learning_rate);
+}
+
+float Network::step(const Tensor& input, const Tensor& target, Loss* loss, float learning_rate) {
+    if (quantized_) {
+        throw std::runtime_error("Network is quantized for inference; call dequantize() before training");
+    }
+    // Parameter update tasks, rebuilt only when the layer list changed
+    updates_.resize(layers_.size());
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        if (updates_[i].layer != layers_[i]) {
+            // The layer list changed since the last step
+            size_t parameters = 0;
+            for (auto* param : layers_[i]->get_parameters()) {
+                parameters += param->size();
+            }
+            updates_[i] = ParameterUpdate{layers_[i], learning_rate, parameters};
+        }
+    }
+
+    // Everything allocated from here on is a step temporary
+    std::optional<ArenaScope> scope;
+    if (use_arena_) {
+        scope.emplace();
+    }
+
+    // Forward pass; each layer keeps what its backward pass needs
+    const Tensor* current_input = &input;
     
-    for (auto* layer : layers_) {
-        current_input = layer->forward(current_input);
-        layer_outputs_.push_back(current_input);
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        current_input = &layers_[i]->forward(*current_input);
     }
     
-    // Compute initial gradient (derivative of loss w.r.t. output)
-    // For MSE: d/dx [(x - t)^2] = 2 * (x - t)
-    Tensor grad_output = (current_input - target) * 2.0f;
+    // Compute initial gradient (derivative of loss w.r.t. output), with the
+    // loss value from the same pass when a Loss is given. Otherwise the loss
+    // is the squared error summed over the outputs of a sample and averaged
+    // over the batch columns, so the step size does not depend on the batch:
+    // d/dx [(x - t)^2 / batch] = 2 * (x - t) / batch
+    float loss_value = 0.0f;
+    if (loss) {
+        loss_value = loss->compute_with_gradient(grad_output_, *current_input, target);
+    } else {
+        grad_output_ = (*current_input - target) * (2.0f / current_input->cols());
+    }
     
-    // Backward pass - propagate gradients through layers in reverse order
+    // Backward pass - propagate gradients through layers in reverse order.
+    // A layer's update only touches its own parameters, so large updates
+    // run as tasks that overlap the backward pass of the layers below.
+    TaskGroup updates;
+    const Tensor* grad_output = &grad_output_;
     for (int i = static_cast<int>(layers_.size()) - 1; i >= 0; --i) {
-        grad_output = layers_[i]->backward(grad_output);
-        layers_[i]->update_parameters(learning_rate);
+        grad_output = &layers_[i]->backward(*grad_output);
+        if (optimizer_) {
+            continue;
+        }
+        updates_[i].learning_rate = learning_rate;
+        if (updates_[i].parameters >= PARALLEL_UPDATE_PARAMETERS) {
+            updates.run(updates_[i]);
+        } else {
+            updates_[i]();
+        }
+    }
+    updates.wait();
+    if (optimizer_) {
+        optimizer_->step(layers_, learning_rate);
+    }
+    
+    // Release the cached activations so the next forward pass can write
+    // into the layer buffers they share without copying them first
+    for (auto* layer : layers_) {
+        layer->clear_cache();
+    }
+    return loss_value;
+}
+
+void Network::save(const std::string& path) const {
+    ModelHeader header = {};
+    std::memcpy(header.magic, MODEL_MAGIC, sizeof(header.magic));
+    header.version_major = MODEL_VERSION_MAJOR;
+    header.version_minor = MODEL_VERSION_MINOR;
+    header.byte_order_mark = MODEL_BYTE_ORDER_MARK;
+    header.layer_count = static_cast<uint32_t>(layers_.size());
+    header.math_precision = static_cast<uint32_t>(math_precision_);
+    header.storage_type = static_cast<uint32_t>(storage_type_);
+
+    // Records first, then each parameter at the next aligned offset
+    std::vector<LayerRecord> layer_records;
+    std::vector<TensorRecord> tensor_records;
+    std::vector<Tensor> tensors;
+    for (auto* layer : layers_) {
+        const char* type = layer->type_name();
+        if (!type || std::strlen(type) >= sizeof(LayerRecord::type)) {
+            throw std::runtime_error("Network::save found a layer type it cannot save");
+        }
+        LayerRecord record = {};
+        std::strncpy(record.type, type, sizeof(record.type) - 1);
+        if (auto* linear = dynamic_cast<const Linear*>(layer)) {
+            record.activation = static_cast<uint32_t>(linear->get_activation());
+        }
+        for (auto* param : layer->get_parameters()) {
+            if (param->rank() == 0 || param->rank() > Shape::MAX_RANK) {
+                throw std::runtime_error("Network::save cannot save a tensor of rank " + std::to_string(param->rank()));
+            }
+            TensorRecord tensor = {};
+            tensor.dtype = static_cast<uint32_t>(param->dtype());
+            tensor.rank = static_cast<uint32_t>(param->rank());
+            for (size_t i = 0; i < param->rank(); ++i) {
+                tensor.shape[i] = param->shape()[i];
+            }
+            tensor.bytes = param->size() * dtype_size(param->dtype());
+            tensor_records.push_back(tensor);
+            tensors.push_back(param->contiguous());
+            ++record.tensor_count;
+        }
+        layer_records.push_back(record);
+    }
+    size_t offset = align_up(sizeof(ModelHeader) + layer_records.size() * sizeof(LayerRecord) +
+                             tensor_records.size() * sizeof(TensorRecord));
+    for (auto& tensor : tensor_records) {
+        tensor.offset = offset;
+        offset = align_up(offset + tensor.bytes);
+    }
+    header.file_size = offset;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot create model file: " + path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    size_t next_tensor = 0;
+    for (const auto& record : layer_records) {
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        for (uint32_t i = 0; i < record.tensor_count; ++i, ++next_tensor) {
+            out.write(reinterpret_cast<const char*>(&tensor_records[next_tensor]), sizeof(TensorRecord));
+        }
+    }
+    static const char padding[MODEL_ALIGNMENT] = {};
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        out.write(padding, static_cast<std::streamsize>(tensor_records[i].offset - static_cast<size_t>(out.tellp())));
+        out.write(static_cast<const char*>(tensors[i].raw_data()), static_cast<std::streamsize>(tensor_records[i].bytes));
+    }
+    out.write(padding, static_cast<std::streamsize>(header.file_size - static_cast<size_t>(out.tellp())));
+    if (!out.flush()) {
+        throw std::runtime_error("Cannot write model file: " + path);
+    }
+}
+
+void Network::load(const std::string& path) {
+    auto file = std::make_shared<MappedFile>(path);
+    const auto& header = model_record<ModelHeader>(*file, 0);
+    if (std::memcmp(header.magic, MODEL_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a model file: " + path);
+    }
+    if (header.version_major != MODEL_VERSION_MAJOR) {
+        throw std::runtime_error("Unsupported model file version " + std::to_string(header.version_major));
+    }
+    if (header.byte_order_mark != MODEL_BYTE_ORDER_MARK) {
+        throw std::runtime_error("Model file was written with a different byte order");
+    }
+    if (header.file_size != file->size()) {
+        throw std::runtime_error("Model file is truncated");
+    }
+    if (header.math_precision > static_cast<uint32_t>(MathPrecision::Fast) ||
+        header.storage_type > static_cast<uint32_t>(DType::Float16)) {
+        throw std::runtime_error("Model file has an invalid header");
+    }
+
+    // Build every layer before touching the current ones
+    std::vector<std::unique_ptr<Layer>> layers;
+    size_t offset = sizeof(ModelHeader);
+    for (uint32_t i = 0; i < header.layer_count; ++i) {
+        const auto& record = model_record<LayerRecord>(*file, offset);
+        offset += sizeof(LayerRecord);
+        std::vector<Tensor> tensors;
+        for (uint32_t t = 0; t < record.tensor_count; ++t) {
+            tensors.push_back(model_tensor(*file, model_record<TensorRecord>(*file, offset)));
+            offset += sizeof(TensorRecord);
+        }
+        const std::string type(record.type, strnlen(record.type, sizeof(record.type)));
+        layers.emplace_back(make_layer(type, record, tensors));
+    }
+
+    // The old layers may point into the previous mapping, so they go first
+    for (auto* layer : layers_) {
+        delete layer;
+    }
+    layers_.clear();
+    updates_.clear();
+    quantized_ = false;
+    model_file_ = std::move(file);
+    math_precision_ = static_cast<MathPrecision>(header.math_precision);
+    storage_type_ = static_cast<DType>(header.storage_type);
+    for (auto& layer : layers) {
+        add_layer(layer.release());
     }
 }
 
-} // namespace nn
\ No newline at end of file
+} // namespace nn
@@ -0,0 +1,169 @@
+#include "Optimizer.h"
+#include "Scheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nn {
+
+namespace {
+
+// Elements of a 16-bit parameter widened at a time
+constexpr size_t UPDATE_CHUNK = 1024;
+
+} // namespace
+
+bool Optimizer::segments_match(const std::vector<Layer*>& layers) const {
+    if (layers != layers_) {
+        return false;
+    }
+    for (const Segment& segment : segments_) {
+        if (segment.parameter->size() != segment.size) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Optimizer::build_segments(const std::vector<Layer*>& layers) {
+    layers_ = layers;
+    segments_.clear();
+    total_ = 0;
+    for (auto* layer : layers) {
+        const auto parameters = layer->get_parameters();
+        const auto gradients = layer->get_gradients();
+        if (parameters.size() != gradients.size()) {
+            throw std::runtime_error("Layer has a different number of parameters and gradients");
+        }
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            segments_.push_back(Segment{layer, parameters[i], gradients[i], total_, parameters[i]->size()});
+            total_ += parameters[i]->size();
+        }
+    }
+    gradients_.resize(segments_.size());
+    parameters_.resize(segments_.size());
+}
+
+void Optimizer::reset() {
+    state_valid_ = false;
+}
+
+void Optimizer::step(const std::vector<Layer*>& layers, float learning_rate) {
+    if (!segments_match(layers)) {
+        build_segments(layers);
+        reset();
+    }
+    if (!state_valid_) {
+        state_.resize(Shape{slots_ * total_});
+        state_.fill(0.0f);
+        state_valid_ = true;
+    }
+
+    // Gradients are read as float32; parameters are written in their own
+    // dtype through a contiguous buffer
+    for (size_t s = 0; s < segments_.size(); ++s) {
+        Segment& segment = segments_[s];
+        const Tensor& gradient = *segment.gradient;
+        if (gradient.size() != segment.size || gradient.dtype() != DType::Float32 || !gradient.is_contiguous()) {
+            throw std::runtime_error("Optimizer needs a float32 gradient of each parameter's size; run backward first");
+        }
+        if (!segment.parameter->is_contiguous()) {
+            throw std::runtime_error("Optimizer parameters must be contiguous");
+        }
+        gradients_[s] = gradient.data();
+        parameters_[s] = segment.parameter->raw_data();
+    }
+
+    begin_step(learning_rate);
+    float* state = slots_ == 0 ? nullptr : state_.data();
+    const auto& convert = kernels::conversions();
+    parallel_for(total_, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        // First segment ending after begin
+        size_t s = std::upper_bound(segments_.begin(), segments_.end(), begin,
+                                    [](size_t i, const Segment& segment) { return i < segment.begin + segment.size; }) -
+                   segments_.begin();
+        for (; s < segments_.size() && segments_[s].begin < end; ++s) {
+            const Segment& segment = segments_[s];
+            const size_t first = std::max(begin, segment.begin) - segment.begin;
+            const size_t last = std::min(end, segment.begin + segment.size) - segment.begin;
+            float* slot = state ? state + slots_ * segment.begin + first : nullptr;
+            const DType dtype = segment.parameter->dtype();
+            if (dtype == DType::Float32) {
+                update(gradients_[s] + first, static_cast<float*>(parameters_[s]) + first, slot, segment.size,
+                       last - first);
+                continue;
+            }
+            uint16_t* data = static_cast<uint16_t*>(parameters_[s]);
+            float buffer[UPDATE_CHUNK];
+            for (size_t i = first; i < last; i += UPDATE_CHUNK) {
+                const size_t count = std::min(UPDATE_CHUNK, last - i);
+                (dtype == DType::BFloat16 ? convert.bf16_to_float : convert.fp16_to_float)(data + i, buffer, count);
+                update(gradients_[s] + i, buffer, slot ? slot + (i - first) : nullptr, segment.size, count);
+                (dtype == DType::BFloat16 ? convert.float_to_bf16 : convert.float_to_fp16)(buffer, data + i, count);
+            }
+        }
+    });
+
+    // Let each layer refresh what it derives from its parameters once
+    Layer* previous = nullptr;
+    for (const Segment& segment : segments_) {
+        if (segment.layer != previous) {
+            segment.layer->parameters_updated();
+            previous = segment.layer;
+        }
+    }
+}
+
+SGD::SGD(float momentum, bool nesterov, float weight_decay)
+    : Optimizer(momentum != 0.0f ? 1 : 0), step_{0.0f, momentum, weight_decay, nesterov} {
+    if (nesterov && momentum == 0.0f) {
+        throw std::runtime_error("Nesterov momentum needs a nonzero momentum");
+    }
+}
+
+void SGD::begin_step(float learning_rate) {
+    step_.learning_rate = learning_rate;
+}
+
+void SGD::update(const float* g, float* w, float* state, size_t, size_t n) const {
+    kernels::optimizer().sgd(g, w, state, n, step_);
+}
+
+Adam::Adam(float beta1, float beta2, float epsilon, float weight_decay)
+    : Adam(beta1, beta2, epsilon, weight_decay, false) {}
+
+Adam::Adam(float beta1, float beta2, float epsilon, float weight_decay, bool decoupled)
+    : Optimizer(2), beta1_(beta1), beta2_(beta2), epsilon_(epsilon), weight_decay_(weight_decay),
+      decoupled_(decoupled), step_() {
+    if (!(beta1 >= 0.0f && beta1 < 1.0f) || !(beta2 >= 0.0f && beta2 < 1.0f)) {
+        throw std::runtime_error("Adam betas must be in [0, 1)");
+    }
+}
+
+void Adam::reset() {
+    steps_ = 0;
+    Optimizer::reset();
+}
+
+void Adam::begin_step(float learning_rate) {
+    ++steps_;
+    const double t = static_cast<double>(steps_);
+    const double correction1 = 1.0 - std::pow(static_cast<double>(beta1_), t);
+    const double correction2 = 1.0 - std::pow(static_cast<double>(beta2_), t);
+    step_.step_size = static_cast<float>(learning_rate / correction1);
+    step_.beta1 = beta1_;
+    step_.beta2 = beta2_;
+    step_.epsilon = epsilon_;
+    step_.inv_sqrt_correction2 = static_cast<float>(1.0 / std::sqrt(correction2));
+    step_.weight_decay = decoupled_ ? 0.0f : weight_decay_;
+    step_.decay = decoupled_ ? 1.0f - learning_rate * weight_decay_ : 1.0f;
+}
+
+void Adam::update(const float* g, float* w, float* state, size_t slot_stride, size_t n) const {
+    kernels::optimizer().adam(g, w, state, state + slot_stride, n, step_);
+}
+
+AdamW::AdamW(float beta1, float beta2, float epsilon, float weight_decay)
+    : Adam(beta1, beta2, epsilon, weight_decay, true) {}
+
+} // namespace nn
@@ -0,0 +1,226 @@
+#include "Quantize.h"
+#include "Kernels.h"
+#include "Scheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nn {
+
+namespace {
+
+using kernels::QUANT_TILE_COLS;
+using kernels::QUANT_TILE_ROWS;
+
+// Largest activation and weight magnitudes after quantization
+constexpr int32_t ACTIVATION_MAX = 127;
+constexpr int32_t WEIGHT_MAX = 127;
+
+// Below this many multiply-adds the product stays on the calling thread
+constexpr size_t PARALLEL_QUANT_FLOPS = size_t(1) << 20;
+
+// Fewest weight rows handed to one task
+constexpr size_t MIN_QUANT_STRIP = 64;
+
+// One quantized row of activations, used within a single chunk of
+// pack_activations and reused across calls
+thread_local std::vector<uint8_t> quantized_row;
+
+// Bytes of activations packed by pack_activations
+size_t packed_activation_bytes(size_t batch, size_t quads) {
+    const size_t blocks = (batch + QUANT_TILE_COLS - 1) / QUANT_TILE_COLS;
+    return blocks * quads * QUANT_TILE_COLS * 4;
+}
+
+// Quantizes x (cols x batch, contiguous float32) into packed: for each
+// block of QUANT_TILE_COLS columns, each quad of rows holds 4 bytes per
+// column. Padding rows and columns are 0, so every byte is written.
+void pack_activations(const float* x, size_t cols, size_t batch, size_t quads,
+                      const ActivationQuantization& input, uint8_t* packed) {
+    const size_t blocks = (batch + QUANT_TILE_COLS - 1) / QUANT_TILE_COLS;
+    const size_t block_bytes = quads * QUANT_TILE_COLS * 4;
+    const float inv_scale = 1.0f / input.scale;
+    const float zero_point = static_cast<float>(input.zero_point);
+
+    parallel_for(quads, std::max<size_t>(1, ELEMENTWISE_GRAIN / (4 * std::max<size_t>(batch, 1))),
+                 [&](size_t begin, size_t end) {
+        if (quantized_row.size() < blocks * QUANT_TILE_COLS) {
+            quantized_row.resize(blocks * QUANT_TILE_COLS);
+        }
+        uint8_t* row = quantized_row.data();
+        std::fill(row + batch, row + blocks * QUANT_TILE_COLS, uint8_t(0));
+        for (size_t k = begin * 4; k < end * 4; ++k) {
+            if (k < cols) {
+                kernels::quantized().quantize(x + k * batch, row, batch, inv_scale, zero_point);
+            } else {
+                std::fill(row, row + batch, uint8_t(0));
+            }
+            const size_t quad = k / 4;
+            const size_t lane = k % 4;
+            for (size_t b = 0; b < blocks; ++b) {
+                uint8_t* dst = packed + b * block_bytes + quad * QUANT_TILE_COLS * 4 + lane;
+                const uint8_t* src = row + b * QUANT_TILE_COLS;
+                for (size_t j = 0; j < QUANT_TILE_COLS; ++j) {
+                    dst[j * 4] = src[j];
+                }
+            }
+        }
+    });
+}
+
+} // namespace
+
+ActivationQuantization ActivationQuantization::from_range(float min, float max) {
+    min = std::min(min, 0.0f);
+    max = std::max(max, 0.0f);
+    ActivationQuantization result;
+    const float range = max - min;
+    if (!(range > 0.0f) || !std::isfinite(range)) {
+        return result;
+    }
+    result.scale = range / ACTIVATION_MAX;
+    const float zero = std::nearbyint(-min / result.scale);
+    result.zero_point = static_cast<int32_t>(std::min(std::max(zero, 0.0f), float(ACTIVATION_MAX)));
+    return result;
+}
+
+ActivationQuantization ActivationQuantization::calibrate(const Tensor& sample) {
+    const Tensor values = sample.to(DType::Float32).contiguous();
+    const float* data = values.data();
+    float min = 0.0f;
+    float max = 0.0f;
+    for (size_t i = 0; i < values.size(); ++i) {
+        min = std::min(min, data[i]);
+        max = std::max(max, data[i]);
+    }
+    return from_range(min, max);
+}
+
+QuantizedMatrix::QuantizedMatrix(const Tensor& weights) {
+    if (weights.rank() != 2) {
+        throw std::runtime_error("QuantizedMatrix expects a 2-D tensor");
+    }
+    const Tensor w = weights.to(DType::Float32).contiguous();
+    rows_ = w.rows();
+    cols_ = w.cols();
+    quads_ = (cols_ + 3) / 4;
+    const size_t slivers = (rows_ + QUANT_TILE_ROWS - 1) / QUANT_TILE_ROWS;
+    packed_.assign(slivers * quads_ * QUANT_TILE_ROWS * 4, 0);
+    scales_.assign(rows_, 1.0f);
+    row_sums_.assign(rows_, 0);
+
+    for (size_t i = 0; i < rows_; ++i) {
+        const float* row = w.data() + i * cols_;
+        float largest = 0.0f;
+        for (size_t k = 0; k < cols_; ++k) {
+            largest = std::max(largest, std::fabs(row[k]));
+        }
+        if (largest > 0.0f && std::isfinite(largest)) {
+            scales_[i] = largest / WEIGHT_MAX;
+        }
+
+        // Sliver i / ROWS, quad k / 4, row i % ROWS, byte k % 4
+        int8_t* sliver = packed_.data() + (i / QUANT_TILE_ROWS) * quads_ * QUANT_TILE_ROWS * 4;
+        const size_t r = i % QUANT_TILE_ROWS;
+        int32_t sum = 0;
+        for (size_t k = 0; k < cols_; ++k) {
+            float q = std::nearbyint(row[k] / scales_[i]);
+            q = std::min(std::max(q, float(-WEIGHT_MAX)), float(WEIGHT_MAX));
+            const int8_t value = static_cast<int8_t>(q);
+            sliver[(k / 4) * QUANT_TILE_ROWS * 4 + r * 4 + k % 4] = value;
+            sum += value;
+        }
+        row_sums_[i] = sum;
+    }
+}
+
+size_t QuantizedMatrix::bytes() const {
+    return packed_.size() + scales_.size() * sizeof(float) + row_sums_.size() * sizeof(int32_t);
+}
+
+Tensor QuantizedMatrix::dequantize() const {
+    Tensor result(rows_, cols_);
+    for (size_t i = 0; i < rows_; ++i) {
+        const int8_t* sliver = packed_.data() + (i / QUANT_TILE_ROWS) * quads_ * QUANT_TILE_ROWS * 4;
+        const size_t r = i % QUANT_TILE_ROWS;
+        for (size_t k = 0; k < cols_; ++k) {
+            result(i, k) = scales_[i] * sliver[(k / 4) * QUANT_TILE_ROWS * 4 + r * 4 + k % 4];
+        }
+    }
+    return result;
+}
+
+void quantized_linear_into(Tensor& dst, const QuantizedMatrix& weights, const Tensor& x,
+                           const ActivationQuantization& input, const Tensor& bias) {
+    if (x.rank() != 2 || x.rows() != weights.cols()) {
+        throw std::runtime_error("Quantized matmul dimensions incompatible");
+    }
+    if (bias.size() != 0 && bias.size() != weights.rows()) {
+        throw std::runtime_error("Quantized matmul bias must have one value per row");
+    }
+    if (&dst == &x || &dst == &bias) {
+        throw std::runtime_error("quantized_linear_into destination must not alias an operand");
+    }
+
+    Tensor scratch;
+    const Tensor* in = &x;
+    if (!x.is_contiguous() || x.dtype() != DType::Float32) {
+        convert_into(scratch, x, DType::Float32);
+        in = &scratch;
+    }
+    const size_t rows = weights.rows();
+    const size_t batch = x.cols();
+    const size_t quads = weights.quads_;
+    dst.resize(rows, batch);
+    if (rows == 0 || batch == 0) {
+        return;
+    }
+    // The packed activations belong to this call: the thread keeps reading
+    // them while it waits on the strips below, and waiting can run another
+    // product on the same thread. They come from the current allocator, so
+    // inside an ArenaScope they cost no heap allocation.
+    Tensor packed_x;
+    packed_x.resize(Shape{(packed_activation_bytes(batch, quads) + sizeof(float) - 1) / sizeof(float)});
+    uint8_t* packed = static_cast<uint8_t*>(packed_x.raw_data());
+    pack_activations(in->data(), weights.cols(), batch, quads, input, packed);
+
+    const Tensor* b = bias.size() == 0 ? nullptr : &bias;
+    float* out = dst.data();
+    const size_t blocks = (batch + QUANT_TILE_COLS - 1) / QUANT_TILE_COLS;
+    const size_t slivers = (rows + QUANT_TILE_ROWS - 1) / QUANT_TILE_ROWS;
+
+    // Each task takes a strip of weight rows and walks every column block,
+    // keeping one block of activations in L1 across its slivers
+    auto strip = [&](size_t begin, size_t end) {
+        const auto& kernels = kernels::quantized();
+        int32_t tile[QUANT_TILE_ROWS * QUANT_TILE_COLS];
+        for (size_t jb = 0; jb < blocks; ++jb) {
+            const uint8_t* block = packed + jb * quads * QUANT_TILE_COLS * 4;
+            const size_t j0 = jb * QUANT_TILE_COLS;
+            const size_t nc = std::min(QUANT_TILE_COLS, batch - j0);
+            for (size_t s = begin; s < end; ++s) {
+                kernels.tile(quads, weights.packed_.data() + s * quads * QUANT_TILE_ROWS * 4, block, tile);
+                const size_t i0 = s * QUANT_TILE_ROWS;
+                const size_t mr = std::min(QUANT_TILE_ROWS, rows - i0);
+                for (size_t r = 0; r < mr; ++r) {
+                    const size_t i = i0 + r;
+                    const int32_t offset = input.zero_point * weights.row_sums_[i];
+                    const float scale = weights.scales_[i] * input.scale;
+                    const float shift = b ? (*b)[i] : 0.0f;
+                    float* out_row = out + i * batch + j0;
+                    for (size_t j = 0; j < nc; ++j) {
+                        out_row[j] = static_cast<float>(tile[r * QUANT_TILE_COLS + j] - offset) * scale + shift;
+                    }
+                }
+            }
+        }
+    };
+
+    if (rows * batch * weights.cols() >= PARALLEL_QUANT_FLOPS) {
+        parallel_for(slivers, MIN_QUANT_STRIP / QUANT_TILE_ROWS, strip);
+    } else {
+        strip(0, slivers);
+    }
+}
+
+} // namespace nn
@@ -0,0 +1,322 @@
+#include "Scheduler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+namespace nn {
+
+namespace {
+
+// Failed searches before an idle worker goes to sleep
+constexpr int IDLE_SPINS = 64;
+
+// parallel_for splits into at least this many chunks per thread
+constexpr size_t CHUNKS_PER_THREAD = 4;
+
+// Scheduler and slot of the calling thread, if it is a worker
+thread_local const Scheduler* worker_scheduler = nullptr;
+thread_local size_t worker_slot = 0;
+
+std::mutex scheduler_mutex;
+std::unique_ptr<Scheduler> global_scheduler;
+std::atomic<Scheduler*> current_scheduler{nullptr};
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Runs fn over [begin, end), handing the upper halves to other threads.
+// begin is always a multiple of grain.
+void run_range(const ChunkFn& fn, size_t begin, size_t end, size_t grain) {
+    struct Half {
+        const ChunkFn* fn;
+        size_t begin;
+        size_t end;
+        size_t grain;
+        void operator()() const { run_range(*fn, begin, end, grain); }
+    };
+
+    // Halving at most 64 times covers any range
+    Half halves[64];
+    size_t count = 0;
+    TaskGroup group;
+    for (size_t grains = (end - begin + grain - 1) / grain; grains >= 2 && count < 64;
+         grains = (end - begin + grain - 1) / grain) {
+        const size_t mid = begin + grains / 2 * grain;
+        halves[count] = Half{&fn, mid, end, grain};
+        group.run(halves[count]);
+        ++count;
+        end = mid;
+    }
+    fn(begin, end);
+    group.wait();
+}
+
+} // namespace
+
+Scheduler::Scheduler(size_t num_threads) : stats_start_(std::chrono::steady_clock::now()) {
+    num_threads = std::max<size_t>(num_threads, 1);
+    for (size_t i = 0; i < num_threads; ++i) {
+        slots_.emplace_back(new Slot());
+    }
+    for (size_t i = 1; i < num_threads; ++i) {
+        workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+Scheduler::~Scheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t Scheduler::current_slot() const {
+    return worker_scheduler == this ? worker_slot : 0;
+}
+
+void Scheduler::parallel_for(size_t n, size_t grain, ChunkFn fn) {
+    grain = std::max<size_t>(grain, 1);
+    // Coarsen the grain so the split stops at a few chunks per thread
+    const size_t target = CHUNKS_PER_THREAD * num_threads();
+    const size_t grains = (n + grain - 1) / grain;
+    if (grains > target) {
+        grain *= (grains + target - 1) / target;
+    }
+    run_range(fn, 0, n, grain);
+}
+
+void Scheduler::spawn(const Task& task) {
+    Slot& slot = *slots_[current_slot()];
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        if (slot.tail - slot.head < QUEUE_CAPACITY) {
+            slot.tasks[slot.tail % QUEUE_CAPACITY] = task;
+            ++slot.tail;
+            queued_.fetch_add(1);
+            queued = true;
+        }
+    }
+    if (!queued) {
+        execute(task, slot, false);
+        return;
+    }
+
+    // Pairs with the sleeping_ increment in worker_loop: either the sleeper
+    // sees the new task or we see the sleeper
+    if (sleeping_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.notify_one();
+    }
+}
+
+bool Scheduler::pop(Slot& slot, Task& task) {
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    if (slot.tail == slot.head) {
+        return false;
+    }
+    --slot.tail;
+    task = slot.tasks[slot.tail % QUEUE_CAPACITY];
+    queued_.fetch_sub(1);
+    return true;
+}
+
+bool Scheduler::steal(Slot& slot, Task& task) {
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    if (slot.tail == slot.head) {
+        return false;
+    }
+    task = slot.tasks[slot.head % QUEUE_CAPACITY];
+    ++slot.head;
+    queued_.fetch_sub(1);
+    return true;
+}
+
+void Scheduler::execute(const Task& task, Slot& slot, bool stolen) {
+    slot.tasks_run.fetch_add(1, std::memory_order_relaxed);
+    if (stolen) {
+        slot.tasks_stolen.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::exception_ptr error;
+    try {
+        task.call(task.object);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    task.group->finish(error);
+}
+
+bool Scheduler::run_one() {
+    const size_t self = current_slot();
+    Slot& own = *slots_[self];
+    Task task;
+    if (pop(own, task)) {
+        execute(task, own, false);
+        return true;
+    }
+    if (queued_.load() == 0) {
+        return false;
+    }
+    for (size_t i = 1; i < slots_.size(); ++i) {
+        if (steal(*slots_[(self + i) % slots_.size()], task)) {
+            execute(task, own, true);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::help_until_done(const std::atomic<size_t>& pending) {
+    Slot& slot = *slots_[current_slot()];
+    int64_t idle_start = 0;
+    while (pending.load(std::memory_order_acquire) != 0) {
+        if (run_one()) {
+            if (idle_start != 0) {
+                slot.idle_ns.fetch_add(now_ns() - idle_start, std::memory_order_relaxed);
+                idle_start = 0;
+            }
+        } else {
+            // The remaining tasks are running on other threads
+            if (idle_start == 0) {
+                idle_start = now_ns();
+            }
+            std::this_thread::yield();
+        }
+    }
+    if (idle_start != 0) {
+        slot.idle_ns.fetch_add(now_ns() - idle_start, std::memory_order_relaxed);
+    }
+}
+
+void Scheduler::worker_loop(size_t index) {
+    worker_scheduler = this;
+    worker_slot = index;
+    Slot& slot = *slots_[index];
+
+    for (;;) {
+        if (run_one()) {
+            continue;
+        }
+
+        slot.idle_since.store(now_ns(), std::memory_order_relaxed);
+        bool found = false;
+        for (int spin = 0; spin < IDLE_SPINS && !found; ++spin) {
+            std::this_thread::yield();
+            found = queued_.load() > 0;
+        }
+        if (!found) {
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            sleeping_.fetch_add(1);
+            sleep_cv_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+            sleeping_.fetch_sub(1);
+            if (stop_) {
+                return;
+            }
+        }
+        // reset_stats may have moved the start of this idle period
+        const int64_t since = slot.idle_since.exchange(0, std::memory_order_relaxed);
+        slot.idle_ns.fetch_add(now_ns() - since, std::memory_order_relaxed);
+    }
+}
+
+std::vector<WorkerStats> Scheduler::stats() const {
+    const int64_t now = now_ns();
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - stats_start_).count();
+    std::vector<WorkerStats> result(slots_.size());
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        const Slot& slot = *slots_[i];
+        int64_t idle = slot.idle_ns.load(std::memory_order_relaxed);
+        const int64_t since = slot.idle_since.load(std::memory_order_relaxed);
+        if (since != 0) {
+            idle += now - since;
+        }
+        result[i].tasks_run = slot.tasks_run.load(std::memory_order_relaxed);
+        result[i].tasks_stolen = slot.tasks_stolen.load(std::memory_order_relaxed);
+        result[i].idle_seconds = std::min(elapsed, idle * 1e-9);
+        result[i].busy_seconds = elapsed - result[i].idle_seconds;
+    }
+    return result;
+}
+
+void Scheduler::reset_stats() {
+    const int64_t now = now_ns();
+    for (auto& slot : slots_) {
+        slot->tasks_run.store(0, std::memory_order_relaxed);
+        slot->tasks_stolen.store(0, std::memory_order_relaxed);
+        slot->idle_ns.store(0, std::memory_order_relaxed);
+        // An idle period in progress counts from now on
+        int64_t since = slot->idle_since.load(std::memory_order_relaxed);
+        if (since != 0) {
+            slot->idle_since.compare_exchange_strong(since, now, std::memory_order_relaxed);
+        }
+    }
+    stats_start_ = std::chrono::steady_clock::now();
+}
+
+void TaskGroup::finish(std::exception_ptr error) {
+    if (error) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_) {
+            error_ = error;
+        }
+    }
+    pending_.fetch_sub(1, std::memory_order_release);
+}
+
+void TaskGroup::join() {
+    scheduler_.help_until_done(pending_);
+}
+
+void TaskGroup::wait() {
+    join();
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+size_t default_num_threads() {
+    if (const char* env = std::getenv("NN_NUM_THREADS")) {
+        try {
+            const long requested = std::stol(env);
+            if (requested > 0) {
+                return static_cast<size_t>(requested);
+            }
+        } catch (const std::exception&) {
+            // Fall through to the hardware default
+        }
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+Scheduler& scheduler() {
+    if (Scheduler* s = current_scheduler.load(std::memory_order_acquire)) {
+        return *s;
+    }
+    std::lock_guard<std::mutex> lock(scheduler_mutex);
+    if (!global_scheduler) {
+        global_scheduler.reset(new Scheduler(default_num_threads()));
+        current_scheduler.store(global_scheduler.get(), std::memory_order_release);
+    }
+    return *global_scheduler;
+}
+
+void set_num_threads(size_t num_threads) {
+    std::lock_guard<std::mutex> lock(scheduler_mutex);
+    current_scheduler.store(nullptr, std::memory_order_release);
+    global_scheduler.reset(new Scheduler(num_threads == 0 ? default_num_threads() : num_threads));
+    current_scheduler.store(global_scheduler.get(), std::memory_order_release);
+}
+
+size_t num_threads() {
+    return scheduler().num_threads();
+}
+
+} // namespace nn
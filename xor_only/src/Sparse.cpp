@@ -0,0 +1,259 @@
+#include "Sparse.h"
+#include "Kernels.h"
+#include "Scheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace nn {
+
+namespace {
+
+using kernels::SPARSE_BLOCK_ROWS;
+
+// Below this many multiply-adds the product stays on the calling thread
+constexpr size_t PARALLEL_SPARSE_FLOPS = size_t(1) << 20;
+
+// Fewest output rows handed to one task
+constexpr size_t MIN_SPARSE_STRIP = 32;
+
+// Columns of the dense operand swept at a time, so the rows of it that a
+// strip touches stay in cache while every row group reads them
+constexpr size_t SPARSE_PANEL = 256;
+
+// Output of a blocked group that extends past the last row
+thread_local float partial_group[SPARSE_BLOCK_ROWS * SPARSE_PANEL];
+
+// src itself when it is contiguous float32, otherwise a converted copy
+const Tensor& float32_operand(const Tensor& src, Tensor& scratch) {
+    if (src.is_contiguous() && src.dtype() == DType::Float32) {
+        return src;
+    }
+    convert_into(scratch, src, DType::Float32);
+    return scratch;
+}
+
+} // namespace
+
+SparseMatrix::SparseMatrix(const Tensor& dense, SparseFormat format)
+    : format_(format), block_rows_(format == SparseFormat::Blocked ? SPARSE_BLOCK_ROWS : 1) {
+    if (dense.rank() != 2) {
+        throw std::runtime_error("SparseMatrix expects a 2-D tensor");
+    }
+    if (dense.cols() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("SparseMatrix supports at most 2^32 - 1 columns");
+    }
+    Tensor scratch;
+    const Tensor& w = float32_operand(dense, scratch);
+    rows_ = w.rows();
+    cols_ = w.cols();
+    const float* data = w.data();
+
+    const size_t groups = (rows_ + block_rows_ - 1) / block_rows_;
+    group_start_.reserve(groups + 1);
+    for (size_t g = 0; g < groups; ++g) {
+        group_start_.push_back(block_cols_.size());
+        const size_t r0 = g * block_rows_;
+        const size_t r1 = std::min(r0 + block_rows_, rows_);
+        for (size_t c = 0; c < cols_; ++c) {
+            bool nonzero = false;
+            for (size_t r = r0; r < r1; ++r) {
+                nonzero = nonzero || data[r * cols_ + c] != 0.0f;
+            }
+            if (!nonzero) {
+                continue;
+            }
+            block_cols_.push_back(static_cast<uint32_t>(c));
+            for (size_t r = r0; r < r0 + block_rows_; ++r) {
+                const float value = r < r1 ? data[r * cols_ + c] : 0.0f;
+                values_.push_back(value);
+                nonzeros_ += value != 0.0f;
+            }
+        }
+    }
+    group_start_.push_back(block_cols_.size());
+}
+
+float SparseMatrix::density() const {
+    return rows_ == 0 || cols_ == 0 ? 0.0f : static_cast<float>(stored()) / (rows_ * cols_);
+}
+
+size_t SparseMatrix::bytes() const {
+    return group_start_.size() * sizeof(size_t) + block_cols_.size() * sizeof(uint32_t) +
+           values_.size() * sizeof(float);
+}
+
+Tensor SparseMatrix::to_dense() const {
+    Tensor result(rows_, cols_);
+    float* out = result.data();
+    for (size_t g = 0; g + 1 < group_start_.size(); ++g) {
+        for (size_t p = group_start_[g]; p < group_start_[g + 1]; ++p) {
+            for (size_t r = 0; r < block_rows_ && g * block_rows_ + r < rows_; ++r) {
+                out[(g * block_rows_ + r) * cols_ + block_cols_[p]] = values_[p * block_rows_ + r];
+            }
+        }
+    }
+    return result;
+}
+
+void SparseMatrix::refresh(Tensor& dense) {
+    if (dense.rank() != 2 || dense.rows() != rows_ || dense.cols() != cols_) {
+        throw std::runtime_error("SparseMatrix::refresh shape mismatch");
+    }
+    // 16-bit or strided weights are updated through a float32 copy
+    Tensor converted;
+    Tensor& w = dense.is_contiguous() && dense.dtype() == DType::Float32 ? dense : converted;
+    if (&w == &converted) {
+        convert_into(converted, dense, DType::Float32);
+    }
+    float* data = w.data();
+
+    const size_t groups = group_start_.size() - 1;
+    const size_t grain = std::max<size_t>(1, ELEMENTWISE_GRAIN / std::max<size_t>(1, block_rows_ * cols_));
+    nonzeros_ = parallel_reduce(groups, grain, size_t(0), [&](size_t begin, size_t end) {
+        size_t count = 0;
+        for (size_t g = begin; g < end; ++g) {
+            for (size_t r = 0; r < block_rows_ && g * block_rows_ + r < rows_; ++r) {
+                float* row = data + (g * block_rows_ + r) * cols_;
+                size_t p = group_start_[g];
+                for (size_t c = 0; c < cols_; ++c) {
+                    if (p < group_start_[g + 1] && block_cols_[p] == c) {
+                        values_[p * block_rows_ + r] = row[c];
+                        count += row[c] != 0.0f;
+                        ++p;
+                    } else {
+                        row[c] = 0.0f;
+                    }
+                }
+            }
+        }
+        return count;
+    }, [](size_t a, size_t b) { return a + b; });
+
+    if (&w == &converted) {
+        convert_into(dense, converted, dense.dtype());
+    }
+}
+
+void sparse_matmul_into(Tensor& dst, const SparseMatrix& a, const Tensor& b) {
+    if (b.rank() != 2 || b.rows() != a.cols()) {
+        throw std::runtime_error("Sparse matmul dimensions incompatible");
+    }
+    if (&dst == &b) {
+        throw std::runtime_error("sparse_matmul_into destination must not alias an operand");
+    }
+    Tensor scratch;
+    const Tensor& x = float32_operand(b, scratch);
+    const size_t rows = a.rows();
+    const size_t n = x.cols();
+    dst.resize(rows, n);
+    if (rows == 0 || n == 0) {
+        return;
+    }
+
+    const float* in = x.data();
+    float* out = dst.data();
+    const size_t block_rows = a.block_rows_;
+    const size_t groups = a.group_start_.size() - 1;
+
+    auto strip = [&](size_t begin, size_t end) {
+        const auto& kernels = kernels::sparse();
+        auto kernel = block_rows == 1 ? kernels.csr : kernels.blocked;
+        for (size_t j0 = 0; j0 < n; j0 += SPARSE_PANEL) {
+            const size_t width = std::min(SPARSE_PANEL, n - j0);
+            for (size_t g = begin; g < end; ++g) {
+                const size_t start = a.group_start_[g];
+                const size_t blocks = a.group_start_[g + 1] - start;
+                const size_t r0 = g * block_rows;
+                const uint32_t* cols = a.block_cols_.data() + start;
+                const float* values = a.values_.data() + start * block_rows;
+                if (r0 + block_rows <= rows) {
+                    kernel(blocks, cols, values, in + j0, n, out + r0 * n + j0, n, width);
+                    continue;
+                }
+                kernel(blocks, cols, values, in + j0, n, partial_group, SPARSE_PANEL, width);
+                for (size_t r = r0; r < rows; ++r) {
+                    std::copy(partial_group + (r - r0) * SPARSE_PANEL, partial_group + (r - r0) * SPARSE_PANEL + width,
+                              out + r * n + j0);
+                }
+            }
+        }
+    };
+
+    if (a.stored() * n >= PARALLEL_SPARSE_FLOPS) {
+        parallel_for(groups, std::max<size_t>(1, MIN_SPARSE_STRIP / block_rows), strip);
+    } else {
+        strip(0, groups);
+    }
+}
+
+size_t magnitude_prune(const std::vector<Tensor*>& tensors, float sparsity, size_t block_rows) {
+    block_rows = std::max<size_t>(block_rows, 1);
+    sparsity = std::min(std::max(sparsity, 0.0f), 1.0f);
+
+    // Work on float32 copies; a group is a column block of a 2-D tensor or
+    // a single entry of any other
+    std::vector<Tensor> work;
+    std::vector<float> scores;
+    std::vector<size_t> group_rows;  // Rows per group of each tensor
+    for (Tensor* t : tensors) {
+        work.push_back(t->to(DType::Float32).contiguous());
+        const Tensor& w = work.back();
+        const size_t height = w.rank() == 2 ? block_rows : 1;
+        const size_t rows = w.rank() == 2 ? w.rows() : 1;
+        const size_t cols = w.rank() == 2 ? w.cols() : w.size();
+        group_rows.push_back(height);
+        const float* data = w.data();
+        for (size_t r0 = 0; r0 < rows; r0 += height) {
+            for (size_t c = 0; c < cols; ++c) {
+                float score = 0.0f;
+                for (size_t r = r0; r < std::min(r0 + height, rows); ++r) {
+                    score += std::fabs(data[r * cols + c]);
+                }
+                scores.push_back(score);
+            }
+        }
+    }
+
+    const size_t prune = static_cast<size_t>(sparsity * scores.size());
+    if (prune == 0) {
+        return 0;
+    }
+    std::vector<float> sorted = scores;
+    std::nth_element(sorted.begin(), sorted.begin() + (prune - 1), sorted.end());
+    const float threshold = sorted[prune - 1];
+    size_t ties = prune - static_cast<size_t>(std::count_if(scores.begin(), scores.end(),
+                                                            [&](float s) { return s < threshold; }));
+
+    // Zero every group below the threshold and the first ties at it
+    size_t zeroed = 0;
+    size_t index = 0;
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        Tensor& w = work[i];
+        const size_t height = group_rows[i];
+        const size_t rows = w.rank() == 2 ? w.rows() : 1;
+        const size_t cols = w.rank() == 2 ? w.cols() : w.size();
+        float* data = w.data();
+        for (size_t r0 = 0; r0 < rows; r0 += height) {
+            for (size_t c = 0; c < cols; ++c, ++index) {
+                bool cut = scores[index] < threshold;
+                if (!cut && scores[index] == threshold && ties > 0) {
+                    cut = true;
+                    --ties;
+                }
+                if (!cut) {
+                    continue;
+                }
+                for (size_t r = r0; r < std::min(r0 + height, rows); ++r) {
+                    data[r * cols + c] = 0.0f;
+                    ++zeroed;
+                }
+            }
+        }
+        convert_into(*tensors[i], w, tensors[i]->dtype());
+    }
+    return zeroed;
+}
+
+} // namespace nn
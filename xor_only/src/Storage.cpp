@@ -0,0 +1,197 @@
+#include "Storage.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace nn {
+
+Storage::Block* Storage::allocate_block(Allocator* allocator, size_t capacity) {
+    void* memory = allocator->allocate(sizeof(Block) + capacity * sizeof(float));
+    return new (memory) Block{{1}, allocator, capacity};
+}
+
+Storage::Storage()
+    : allocator_(current_allocator()), block_(nullptr), data_(nullptr), size_(0) {}
+
+Storage::Storage(size_t size)
+    : Storage(size, current_allocator()) {}
+
+Storage::Storage(const float* data, size_t size)
+    : Storage() {
+    if (size > 0) {
+        detach(size);
+        std::memcpy(data_, data, size * sizeof(float));
+        size_ = size;
+    }
+}
+
+Storage::Storage(size_t size, Allocator* allocator)
+    : allocator_(allocator), block_(nullptr), data_(nullptr), size_(0) {
+    resize(size);
+}
+
+Storage Storage::external(float* data, size_t size) {
+    Storage storage;
+    storage.data_ = data;
+    storage.size_ = size;
+    return storage;
+}
+
+Storage Storage::uninitialized(size_t size) {
+    Storage storage;
+    if (size > 0) {
+        storage.detach(size);
+        storage.size_ = size;
+    }
+    return storage;
+}
+
+Storage::Storage(const Storage& other)
+    : Storage() {
+    if (can_share(other)) {
+        share(other);
+    } else {
+        *this = other;
+    }
+}
+
+Storage& Storage::operator=(const Storage& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (external() && other.size_ == size_) {
+        std::memmove(data_, other.data_, size_ * sizeof(float));
+        return *this;
+    }
+    if (block_ && block_ == other.block_) {
+        size_ = other.size_;
+        return *this;
+    }
+    if (can_share(other)) {
+        release();
+        share(other);
+        return *this;
+    }
+
+    // Copy into our own buffer, reusing it when it is ours alone and large enough
+    if (shared() || external() || capacity() < other.size_) {
+        clear();
+        detach(other.size_);
+    }
+    size_ = other.size_;
+    if (size_ > 0) {
+        std::memcpy(data_, other.data_, size_ * sizeof(float));
+    }
+    return *this;
+}
+
+Storage::Storage(Storage&& other)
+    : allocator_(other.allocator_->transient() ? default_allocator() : other.allocator_),
+      block_(nullptr), data_(nullptr), size_(0) {
+    // A new owner may outlive the arena scope, even when it is created
+    // inside one, so it copies an arena buffer instead of taking it.
+    // External memory is passed on as it is.
+    if (!other.external() && !can_share(other)) {
+        *this = other;
+        return;
+    }
+    block_ = std::exchange(other.block_, nullptr);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+}
+
+Storage& Storage::operator=(Storage&& other) {
+    if (!can_share(other) || external()) {
+        return *this = other;
+    }
+    if (this != &other) {
+        release();
+        block_ = std::exchange(other.block_, nullptr);
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+Storage::~Storage() {
+    release();
+}
+
+float* Storage::data() {
+    if (shared()) {
+        detach(size_);
+    }
+    return data_;
+}
+
+size_t Storage::capacity() const {
+    return block_ ? block_->capacity : size_;
+}
+
+bool Storage::shared() const {
+    return block_ && block_->refs.load(std::memory_order_acquire) > 1;
+}
+
+void Storage::resize(size_t size) {
+    if (shared() || size > capacity()) {
+        detach(size);
+    }
+    if (size > size_) {
+        std::fill(data_ + size_, data_ + size, 0.0f);
+    }
+    size_ = size;
+}
+
+void Storage::clear() {
+    release();
+    size_ = 0;
+}
+
+bool Storage::can_share(const Storage& other) const {
+    if (!other.block_) {
+        return !other.data_;  // Empty, or external memory we cannot keep alive
+    }
+    return other.block_->allocator == allocator_ || !other.block_->allocator->transient();
+}
+
+void Storage::share(const Storage& other) {
+    block_ = other.block_;
+    data_ = other.data_;
+    size_ = other.size_;
+    if (block_) {
+        block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Moves this storage onto a buffer of its own with the given capacity,
+// carrying over as many of the current elements as fit
+void Storage::detach(size_t capacity) {
+    const size_t keep = std::min(size_, capacity);
+    if (capacity == 0) {
+        clear();
+        return;
+    }
+    Block* block = allocate_block(allocator_, capacity);
+    float* data = block_data(block);
+    if (keep > 0) {
+        std::memcpy(data, data_, keep * sizeof(float));
+    }
+    release();
+    block_ = block;
+    data_ = data;
+    size_ = keep;
+}
+
+void Storage::release() {
+    if (block_ && block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Allocator* allocator = block_->allocator;
+        const size_t bytes = sizeof(Block) + block_->capacity * sizeof(float);
+        block_->~Block();
+        allocator->deallocate(block_, bytes);
+    }
+    block_ = nullptr;
+    data_ = nullptr;
+}
+
+} // namespace nn
@@ -1,259 +1,1090 @@
 #include "Tensor.h"
+#include "Gemm.h"
+#include "Kernels.h"
+#include "Scheduler.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <random>
 #include <iostream>
 
 namespace nn {
 
-Tensor::Tensor() : data_(), shape_({0, 0}) {}
+namespace {
 
-Tensor::Tensor(const std::vector<float>& data, const std::vector<size_t>& shape) 
-    : data_(data), shape_(shape) {
-    if (data.size() != shape[0] * shape[1]) {
+// Elements converted at a time when a 16-bit tensor is updated in float32
+constexpr size_t CONVERT_CHUNK = 1024;
+
+// Floats of storage holding n elements of dtype
+size_t storage_size(size_t n, DType dtype) {
+    return dtype == DType::Float32 ? n : (n + 1) / 2;
+}
+
+// src itself when it is contiguous float32, otherwise a packed float32 copy
+// held in scratch
+const Tensor& packed(const Tensor& src, Tensor& scratch) {
+    if (src.is_contiguous() && src.dtype() == DType::Float32) {
+        return src;
+    }
+    convert_into(scratch, src, DType::Float32);
+    return scratch;
+}
+
+// A 2-D tensor described as a row-major GEMM operand
+struct GemmOperand {
+    const void* data;
+    DType dtype;
+    size_t ld;
+    Transpose trans;
+};
+
+// Row-major and transposed layouts are read in place, in any dtype;
+// anything else is packed into scratch first
+GemmOperand gemm_operand(const Tensor& t, Transpose trans, Tensor& scratch) {
+    const Transpose flipped = trans == Transpose::Yes ? Transpose::No : Transpose::Yes;
+    const Shape& strides = t.strides();
+    if (t.cols() == 1 || strides[1] == 1) {
+        return {t.raw_data(), t.dtype(), t.rows() == 1 ? t.cols() : strides[0], trans};
+    }
+    if (t.rows() == 1 || strides[0] == 1) {
+        return {t.raw_data(), t.dtype(), strides[1], flipped};
+    }
+    const Tensor& p = packed(t, scratch);
+    return {p.data(), DType::Float32, p.cols(), trans};
+}
+
+// Converts n elements between any two dtypes
+void convert_elements(const void* in, DType from, void* out, DType to, size_t n) {
+    const auto& kernels = kernels::conversions();
+    if (from == to) {
+        std::memcpy(out, in, n * dtype_size(from));
+    } else if (from == DType::Float32) {
+        auto narrow = to == DType::BFloat16 ? kernels.float_to_bf16 : kernels.float_to_fp16;
+        narrow(static_cast<const float*>(in), static_cast<uint16_t*>(out), n);
+    } else if (to == DType::Float32) {
+        auto widen = from == DType::BFloat16 ? kernels.bf16_to_float : kernels.fp16_to_float;
+        widen(static_cast<const uint16_t*>(in), static_cast<float*>(out), n);
+    } else {
+        // Between the 16-bit types through float32
+        float buffer[CONVERT_CHUNK];
+        const uint16_t* src = static_cast<const uint16_t*>(in);
+        uint16_t* dst = static_cast<uint16_t*>(out);
+        for (size_t i = 0; i < n; i += CONVERT_CHUNK) {
+            const size_t count = std::min(CONVERT_CHUNK, n - i);
+            convert_elements(src + i, from, buffer, DType::Float32, count);
+            convert_elements(buffer, DType::Float32, dst + i, to, count);
+        }
+    }
+}
+
+// Applies op(x, begin, n) to the elements of a contiguous 16-bit tensor,
+// widened to float32 in chunks of at most CONVERT_CHUNK, and stores the
+// results back rounded
+template <typename F>
+void update_as_float(Tensor& t, F&& op) {
+    uint16_t* data = static_cast<uint16_t*>(t.raw_data());
+    const DType dtype = t.dtype();
+    parallel_for(t.size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        float buffer[CONVERT_CHUNK];
+        for (size_t i = begin; i < end; i += CONVERT_CHUNK) {
+            const size_t count = std::min(CONVERT_CHUNK, end - i);
+            convert_elements(data + i, dtype, buffer, DType::Float32, count);
+            op(buffer, i, count);
+            convert_elements(buffer, DType::Float32, data + i, dtype, count);
+        }
+    });
+}
+
+// Copies the elements of a strided view into contiguous row-major order
+template <typename T>
+void gather(const T* in, T* out, const Shape& shape, const Shape& strides, size_t offset, size_t size) {
+    // Walk the innermost dimension with its stride, locating each row once
+    const size_t rank = shape.size();
+    const size_t inner = shape[rank - 1];
+    const size_t inner_stride = strides[rank - 1];
+    for (size_t r = 0; r < size / inner; ++r) {
+        size_t pos = offset;
+        size_t rest = r;
+        for (size_t d = rank - 1; d-- > 0;) {
+            pos += (rest % shape[d]) * strides[d];
+            rest /= shape[d];
+        }
+        for (size_t j = 0; j < inner; ++j) {
+            out[r * inner + j] = in[pos + j * inner_stride];
+        }
+    }
+}
+
+// Element-wise kernels over [0, n), split into tasks when n is large
+void parallel_binary(void (*kernel)(const float*, const float*, float*, size_t),
+                     const float* a, const float* b, float* out, size_t n) {
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernel(a + begin, b + begin, out + begin, end - begin);
+    });
+}
+
+void parallel_scalar(void (*kernel)(const float*, float, float*, size_t),
+                     const float* a, float scalar, float* out, size_t n) {
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernel(a + begin, scalar, out + begin, end - begin);
+    });
+}
+
+void parallel_unary(void (*kernel)(const float*, float*, size_t),
+                    const float* in, float* out, size_t n) {
+    parallel_for(n, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernel(in + begin, out + begin, end - begin);
+    });
+}
+
+// t = kernel(t, rhs) for a contiguous tensor of any dtype
+void binary_in_place(Tensor& t, void (*kernel)(const float*, const float*, float*, size_t), const float* rhs) {
+    if (t.dtype() == DType::Float32) {
+        parallel_binary(kernel, t.data(), rhs, t.data(), t.size());
+        return;
+    }
+    update_as_float(t, [&](float* x, size_t begin, size_t n) { kernel(x, rhs + begin, x, n); });
+}
+
+void scalar_in_place(Tensor& t, void (*kernel)(const float*, float, float*, size_t), float scalar) {
+    if (t.dtype() == DType::Float32) {
+        parallel_scalar(kernel, t.data(), scalar, t.data(), t.size());
+        return;
+    }
+    update_as_float(t, [&](float* x, size_t, size_t n) { kernel(x, scalar, x, n); });
+}
+
+// t = t op other for a contiguous t, where other broadcasts to the shape of t
+template <typename Op>
+void broadcast_in_place(Tensor& t, const Tensor& other) {
+    if (broadcast_shape(t.shape(), other.shape(), Op::name) != t.shape()) {
+        throw std::runtime_error(std::string("Tensor shapes do not match for ") + Op::name);
+    }
+    Tensor scratch;
+    const Tensor& rhs = packed(other, scratch);
+    if (t.dtype() != DType::Float32) {
+        Tensor wide;
+        convert_into(wide, t, DType::Float32);
+        broadcast_in_place<Op>(wide, rhs);
+        convert_into(t, wide, t.dtype());
+        return;
+    }
+    float* out = t.data();
+    evaluate(BinaryExpr<TensorOperand, TensorOperand, Op>(TensorOperand(t), TensorOperand(rhs)), out, t.size());
+}
+
+// Whole-array reductions are split into chunks of this many elements; the
+// chunks depend only on the size, so results do not depend on the thread count
+constexpr size_t REDUCE_GRAIN = size_t(1) << 16;
+
+// Column reductions walk the rows in strips of this many columns
+constexpr size_t COLUMN_STRIP = 256;
+
+// Rows added one after another before partial sums are combined pairwise
+constexpr size_t COLUMN_BLOCK_ROWS = 16;
+
+// Partial column sums are reused across calls, like the GEMM packing buffers
+thread_local std::vector<float> column_scratch;
+
+float reduce_sum(const float* x, size_t n) {
+    const auto& kernels = kernels::reductions();
+    return parallel_reduce(n, REDUCE_GRAIN, 0.0f,
+        [&](size_t begin, size_t end) { return kernels.sum(x + begin, end - begin); },
+        [](float left, float right) { return left + right; });
+}
+
+float reduce_max(const float* x, size_t n) {
+    const auto& kernels = kernels::reductions();
+    return parallel_reduce(n, REDUCE_GRAIN, -std::numeric_limits<float>::infinity(),
+        [&](size_t begin, size_t end) { return kernels.max(x + begin, end - begin); },
+        [](float left, float right) { return std::max(left, right); });
+}
+
+// Index of the first maximum; 0 if every element is NaN
+size_t reduce_argmax(const float* x, size_t n) {
+    struct Best {
+        float value;
+        size_t index;
+    };
+    const auto& kernels = kernels::reductions();
+    const Best best = parallel_reduce(n, REDUCE_GRAIN, Best{-std::numeric_limits<float>::infinity(), 0},
+        [&](size_t begin, size_t end) {
+            const float value = kernels.max(x + begin, end - begin);
+            const float* found = std::find(x + begin, x + end, value);
+            return Best{value, found == x + end ? begin : static_cast<size_t>(found - x)};
+        },
+        [](const Best& left, const Best& right) { return right.value > left.value ? right : left; });
+    return best.index;
+}
+
+// out[0, w) = sum of the first rows rows of a strip, adding blocks of rows
+// in order and combining the blocks pairwise. scratch holds one strip per
+// level of the recursion.
+void column_sums(const float* in, size_t ld, size_t rows, size_t w, float* out, float* scratch) {
+    const auto& kernels = kernels::elementwise();
+    if (rows <= COLUMN_BLOCK_ROWS) {
+        std::copy(in, in + w, out);
+        for (size_t r = 1; r < rows; ++r) {
+            kernels.add(out, in + r * ld, out, w);
+        }
+        return;
+    }
+    const size_t half = rows / 2;
+    column_sums(in, ld, half, w, out, scratch + w);
+    column_sums(in + half * ld, ld, rows - half, w, scratch, scratch + w);
+    kernels.add(out, scratch, out, w);
+}
+
+// Runs f(j0, w) for every strip of columns, one task per group of strips
+// holding about REDUCE_GRAIN elements
+template <typename F>
+void for_each_column_strip(size_t rows, size_t cols, F&& f) {
+    const size_t strips = (cols + COLUMN_STRIP - 1) / COLUMN_STRIP;
+    const size_t strip_elements = std::max<size_t>(rows * COLUMN_STRIP, 1);
+    const size_t grain = std::max<size_t>(REDUCE_GRAIN / strip_elements, 1);
+    parallel_for(strips, grain, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; ++s) {
+            const size_t j0 = s * COLUMN_STRIP;
+            f(j0, std::min(COLUMN_STRIP, cols - j0));
+        }
+    });
+}
+
+// Runs f(i) for every row, one task per group of rows holding about
+// REDUCE_GRAIN elements
+template <typename F>
+void for_each_row(size_t rows, size_t cols, F&& f) {
+    const size_t grain = std::max<size_t>(REDUCE_GRAIN / std::max<size_t>(cols, 1), 1);
+    parallel_for(rows, grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            f(i);
+        }
+    });
+}
+
+// Checks the arguments shared by the reductions and returns src packed
+const Tensor& reduction_source(const Tensor& dst, const Tensor& src, int axis, Tensor& scratch, const char* name) {
+    if (&dst == &src) {
+        throw std::runtime_error(std::string(name) + "_into destination must not alias the source");
+    }
+    if (axis != -1 && axis != 0 && axis != 1) {
+        throw std::runtime_error(std::string(name) + " axis must be -1, 0 or 1");
+    }
+    if (axis != -1 && src.rank() != 2) {
+        throw std::runtime_error(std::string(name) + " along an axis expects a 2-D tensor");
+    }
+    return packed(src, scratch);
+}
+
+} // namespace
+
+Shape contiguous_strides(const Shape& shape) {
+    Shape strides = shape;
+    size_t stride = 1;
+    for (size_t d = shape.size(); d-- > 0;) {
+        strides[d] = stride;
+        stride *= shape[d];
+    }
+    return strides;
+}
+
+Shape broadcast_shape(const Shape& a, const Shape& b, const char* operation) {
+    const Shape& longer = a.size() >= b.size() ? a : b;
+    const Shape& shorter = a.size() >= b.size() ? b : a;
+    const size_t skip = longer.size() - shorter.size();
+    Shape result = longer;
+    for (size_t d = 0; d < shorter.size(); ++d) {
+        const size_t x = longer[skip + d];
+        const size_t y = shorter[d];
+        if (x != y && x != 1 && y != 1) {
+            throw std::runtime_error(std::string("Tensor shapes do not match for ") + operation);
+        }
+        result[skip + d] = x == 1 ? y : x;
+    }
+    return result;
+}
+
+Tensor::Tensor() {
+    set_layout({0, 0}, {0, 1}, 0);
+}
+
+Tensor::Tensor(const std::vector<float>& data, const Shape& shape)
+    : data_(data.data(), data.size()) {
+    if (data.size() != shape.numel()) {
         throw std::runtime_error("Data size does not match shape");
     }
+    set_layout(shape, contiguous_strides(shape), 0);
 }
 
 Tensor::Tensor(const std::vector<std::vector<float>>& data) {
     if (data.empty()) {
-        shape_ = {0, 0};
+        set_layout({0, 0}, {0, 1}, 0);
         return;
     }
-    shape_ = {data.size(), data[0].size()};
-    data_.reserve(shape_[0] * shape_[1]);
-    
+    Shape shape = {data.size(), data[0].size()};
+    data_.resize(shape.numel());
+    set_layout(shape, contiguous_strides(shape), 0);
+
+    float* out = data_.data();
+    size_t i = 0;
     for (const auto& row : data) {
         for (float val : row) {
-            data_.push_back(val);
+            out[i++] = val;
         }
     }
 }
 
-Tensor::Tensor(size_t rows, size_t cols) 
-    : shape_({rows, cols}) {
-    data_.resize(rows * cols, 0.0f);
+Tensor::Tensor(size_t rows, size_t cols)
+    : Tensor(Shape{rows, cols}) {}
+
+Tensor::Tensor(const Shape& shape)
+    : data_(shape.numel()) {
+    set_layout(shape, contiguous_strides(shape), 0);
 }
 
-Tensor::Tensor(const Tensor& other) 
-    : data_(other.data_), shape_(other.shape_) {}
+Tensor::Tensor(const Shape& shape, DType dtype)
+    : data_(storage_size(shape.numel(), dtype)), dtype_(dtype) {
+    set_layout(shape, contiguous_strides(shape), 0);
+}
+
+Tensor Tensor::from_external(float* data, const Shape& shape) {
+    return Tensor(ExternalTag{}, data, shape, DType::Float32);
+}
+
+Tensor Tensor::from_external(void* data, const Shape& shape, DType dtype) {
+    return Tensor(ExternalTag{}, data, shape, dtype);
+}
+
+Tensor::Tensor(ExternalTag, void* data, const Shape& shape, DType dtype)
+    : data_(Storage::external(static_cast<float*>(data), storage_size(shape.numel(), dtype))), dtype_(dtype) {
+    set_layout(shape, contiguous_strides(shape), 0);
+}
+
+Tensor::Tensor(UninitializedTag, const Shape& shape)
+    : data_(Storage::uninitialized(shape.numel())) {
+    set_layout(shape, contiguous_strides(shape), 0);
+}
+
+Tensor::Tensor(const Tensor& other)
+    : data_(other.data_), shape_(other.shape_), strides_(other.strides_),
+      offset_(other.offset_), size_(other.size_), contiguous_(other.contiguous_), dtype_(other.dtype_) {}
 
 Tensor& Tensor::operator=(const Tensor& other) {
     if (this != &other) {
         data_ = other.data_;
-        shape_ = other.shape_;
+        dtype_ = other.dtype_;
+        set_layout(other.shape_, other.strides_, other.offset_);
     }
     return *this;
 }
 
-Tensor::Tensor(Tensor&& other) noexcept
-    : data_(std::move(other.data_)), shape_(std::move(other.shape_)) {}
+Tensor::Tensor(Tensor&& other)
+    : data_(std::move(other.data_)), shape_(other.shape_), strides_(other.strides_),
+      offset_(other.offset_), size_(other.size_), contiguous_(other.contiguous_), dtype_(other.dtype_) {}
 
-Tensor& Tensor::operator=(Tensor&& other) noexcept {
+Tensor& Tensor::operator=(Tensor&& other) {
     if (this != &other) {
         data_ = std::move(other.data_);
-        shape_ = std::move(other.shape_);
+        dtype_ = other.dtype_;
+        set_layout(other.shape_, other.strides_, other.offset_);
     }
     return *this;
 }
 
 float& Tensor::operator()(size_t row, size_t col) {
+    check_float32();
     return data_[index(row, col)];
 }
 
 const float& Tensor::operator()(size_t row, size_t col) const {
+    check_float32();
     return data_[index(row, col)];
 }
 
 float& Tensor::operator[](size_t index) {
-    return data_[index];
+    check_float32();
+    return data_[linear_index(index)];
 }
 
 const float& Tensor::operator[](size_t index) const {
-    return data_[index];
+    check_float32();
+    return data_[linear_index(index)];
 }
 
-Tensor Tensor::operator+(const Tensor& other) const {
-    if (shape_ != other.shape_) {
-        throw std::runtime_error("Tensor shapes do not match for addition");
+float& Tensor::at(std::initializer_list<size_t> index) {
+    check_float32();
+    return data_[element_index(index)];
+}
+
+const float& Tensor::at(std::initializer_list<size_t> index) const {
+    check_float32();
+    return data_[element_index(index)];
+}
+
+void* Tensor::raw_data() {
+    return reinterpret_cast<char*>(data_.data()) + offset_ * dtype_size(dtype_);
+}
+
+const void* Tensor::raw_data() const {
+    return reinterpret_cast<const char*>(data_.data()) + offset_ * dtype_size(dtype_);
+}
+
+Tensor Tensor::to(DType dtype) const {
+    if (dtype == dtype_) {
+        return *this;
+    }
+    Tensor result;
+    convert_into(result, *this, dtype);
+    return result;
+}
+
+void Tensor::throw_not_float32() const {
+    throw std::runtime_error(std::string("Operation needs a float32 tensor, not ") + dtype_name(dtype_) +
+                             "; convert it with to(DType::Float32)");
+}
+
+Tensor Tensor::reshape(const Shape& shape) const {
+    if (shape.numel() != size_) {
+        throw std::runtime_error("New shape incompatible with data size");
     }
-    
-    Tensor result(shape_[0], shape_[1]);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = data_[i] + other.data_[i];
+    if (!contiguous_) {
+        return contiguous().reshape(shape);
     }
+    Tensor result(*this);
+    result.set_layout(shape, contiguous_strides(shape), offset_);
     return result;
 }
 
-Tensor Tensor::operator-(const Tensor& other) const {
-    if (shape_ != other.shape_) {
-        throw std::runtime_error("Tensor shapes do not match for subtraction");
+Tensor Tensor::permute(const Shape& dims) const {
+    if (dims.size() != rank()) {
+        throw std::runtime_error("Permutation must list every dimension once");
     }
-    
-    Tensor result(shape_[0], shape_[1]);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = data_[i] - other.data_[i];
+    Shape shape = shape_;
+    Shape strides = strides_;
+    bool seen[Shape::MAX_RANK] = {};
+    for (size_t d = 0; d < dims.size(); ++d) {
+        if (dims[d] >= rank() || seen[dims[d]]) {
+            throw std::runtime_error("Permutation must list every dimension once");
+        }
+        seen[dims[d]] = true;
+        shape[d] = shape_[dims[d]];
+        strides[d] = strides_[dims[d]];
     }
+    Tensor result(*this);
+    result.set_layout(shape, strides, offset_);
     return result;
 }
 
-Tensor Tensor::operator+(float scalar) const {
-    Tensor result(shape_[0], shape_[1]);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = data_[i] + scalar;
+Tensor Tensor::slice(size_t dim, size_t begin, size_t end) const {
+    if (dim >= rank() || begin > end || end > shape_[dim]) {
+        throw std::runtime_error("Slice out of range");
     }
+    Shape shape = shape_;
+    shape[dim] = end - begin;
+    Tensor result(*this);
+    result.set_layout(shape, strides_, offset_ + begin * strides_[dim]);
     return result;
 }
 
-Tensor Tensor::operator-(float scalar) const {
-    Tensor result(shape_[0], shape_[1]);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = data_[i] - scalar;
+Tensor Tensor::contiguous() const {
+    if (contiguous_) {
+        return *this;
+    }
+
+    Tensor result(shape_, dtype_);
+    if (dtype_ == DType::Float32) {
+        gather(data_.data(), result.data(), shape_, strides_, offset_, size_);
+    } else {
+        gather(reinterpret_cast<const uint16_t*>(data_.data()), static_cast<uint16_t*>(result.raw_data()),
+               shape_, strides_, offset_, size_);
     }
     return result;
 }
 
-Tensor Tensor::operator*(const Tensor& other) const {
+Tensor& Tensor::add_(const Tensor& other) {
     if (shape_ != other.shape_) {
-        throw std::runtime_error("Tensor shapes do not match for element-wise multiplication");
+        make_contiguous();
+        broadcast_in_place<AddOp>(*this, other);
+        return *this;
     }
-    
-    Tensor result(shape_[0], shape_[1]);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = data_[i] * other.data_[i];
+    make_contiguous();
+    Tensor scratch;
+    const Tensor& rhs = packed(other, scratch);
+    binary_in_place(*this, kernels::elementwise().add, rhs.data());
+    return *this;
+}
+
+Tensor& Tensor::sub_(const Tensor& other) {
+    if (shape_ != other.shape_) {
+        make_contiguous();
+        broadcast_in_place<SubOp>(*this, other);
+        return *this;
     }
-    return result;
+    make_contiguous();
+    Tensor scratch;
+    const Tensor& rhs = packed(other, scratch);
+    binary_in_place(*this, kernels::elementwise().sub, rhs.data());
+    return *this;
+}
+
+Tensor& Tensor::mul_(const Tensor& other) {
+    if (shape_ != other.shape_) {
+        make_contiguous();
+        broadcast_in_place<MulOp>(*this, other);
+        return *this;
+    }
+    make_contiguous();
+    Tensor scratch;
+    const Tensor& rhs = packed(other, scratch);
+    binary_in_place(*this, kernels::elementwise().mul, rhs.data());
+    return *this;
+}
+
+Tensor& Tensor::add_(float scalar) {
+    make_contiguous();
+    scalar_in_place(*this, kernels::elementwise().add_scalar, scalar);
+    return *this;
+}
+
+Tensor& Tensor::mul_(float scalar) {
+    make_contiguous();
+    scalar_in_place(*this, kernels::elementwise().mul_scalar, scalar);
+    return *this;
 }
 
-Tensor Tensor::operator*(float scalar) const {
-    Tensor result(shape_[0], shape_[1]);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = data_[i] * scalar;
+Tensor& Tensor::axpy_(float alpha, const Tensor& x) {
+    if (shape_ != x.shape_) {
+        throw std::runtime_error("Tensor shapes do not match for axpy");
     }
+    make_contiguous();
+    Tensor scratch;
+    const Tensor& rhs = packed(x, scratch);
+    const float* x_data = rhs.data();
+    if (dtype_ != DType::Float32) {
+        update_as_float(*this, [&](float* y, size_t begin, size_t n) {
+            kernels::elementwise().axpy(alpha, x_data + begin, y, n);
+        });
+        return *this;
+    }
+    float* y_data = data();
+    parallel_for(size_, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernels::elementwise().axpy(alpha, x_data + begin, y_data + begin, end - begin);
+    });
+    return *this;
+}
+
+void Tensor::resize(const Shape& shape) {
+    resize(shape, dtype_);
+}
+
+void Tensor::resize(const Shape& shape, DType dtype) {
+    if (contiguous_ && shape == shape_ && dtype == dtype_) {
+        return;
+    }
+    const Shape new_shape = shape;  // shape may refer to shape_
+    // A view's buffer belongs to a different layout; start a fresh one
+    if (!contiguous_ || offset_ != 0) {
+        data_.clear();
+    }
+    dtype_ = dtype;
+    data_.resize(storage_size(new_shape.numel(), dtype));
+    set_layout(new_shape, contiguous_strides(new_shape), 0);
+}
+
+void Tensor::resize(size_t rows, size_t cols) {
+    resize(Shape{rows, cols});
+}
+
+void Tensor::clear() {
+    data_.clear();
+    set_layout({0, 0}, {0, 1}, 0);
+}
+
+Tensor Tensor::matmul(const Tensor& other) const {
+    Tensor result;
+    matmul_into(result, *this, other);
     return result;
 }
 
-Tensor Tensor::operator/(float scalar) const {
-    if (scalar == 0.0f) {
-        throw std::runtime_error("Division by zero");
+Tensor Tensor::transpose() const {
+    Tensor result;
+    transpose_into(result, *this);
+    return result;
+}
+
+Tensor Tensor::sigmoid(MathPrecision precision) const {
+    Tensor result;
+    sigmoid_into(result, *this, precision);
+    return result;
+}
+
+Tensor Tensor::tanh(MathPrecision precision) const {
+    Tensor result;
+    tanh_into(result, *this, precision);
+    return result;
+}
+
+Tensor Tensor::relu() const {
+    Tensor result;
+    relu_into(result, *this);
+    return result;
+}
+
+Tensor Tensor::exp(MathPrecision precision) const {
+    Tensor result;
+    exp_into(result, *this, precision);
+    return result;
+}
+
+Tensor Tensor::log(MathPrecision precision) const {
+    Tensor result;
+    log_into(result, *this, precision);
+    return result;
+}
+
+void Tensor::fill(float value) {
+    if (!contiguous_) {
+        resize(shape_);
     }
-    
-    Tensor result(shape_[0], shape_[1]);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = data_[i] / scalar;
+    if (dtype_ != DType::Float32) {
+        update_as_float(*this, [&](float* x, size_t, size_t n) { kernels::elementwise().fill(x, value, n); });
+        return;
     }
+    float* out = data();
+    parallel_for(size_, ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        kernels::elementwise().fill(out + begin, value, end - begin);
+    });
+}
+
+Tensor Tensor::sum(int axis) const {
+    Tensor result;
+    sum_into(result, *this, axis);
     return result;
 }
 
-Tensor Tensor::matmul(const Tensor& other) const {
-    if (shape_[1] != other.shape_[0]) {
-        throw std::runtime_error("Matrix dimensions incompatible for multiplication");
+Tensor Tensor::mean(int axis) const {
+    Tensor result;
+    mean_into(result, *this, axis);
+    return result;
+}
+
+Tensor Tensor::max(int axis) const {
+    Tensor result;
+    max_into(result, *this, axis);
+    return result;
+}
+
+Tensor Tensor::argmax(int axis) const {
+    Tensor result;
+    argmax_into(result, *this, axis);
+    return result;
+}
+
+void Tensor::print() const {
+    if (dtype_ != DType::Float32) {
+        to(DType::Float32).print();
+        return;
     }
-    
-    size_t rows = shape_[0];
-    size_t cols = other.shape_[1];
-    size_t inner = shape_[1];
-    
-    Tensor result(rows, cols);
-    
+    // One line per index of the leading dimensions
+    size_t cols = shape_.empty() ? 1 : shape_[rank() - 1];
+    size_t rows = cols == 0 ? 0 : size_ / cols;
     for (size_t i = 0; i < rows; ++i) {
         for (size_t j = 0; j < cols; ++j) {
-            float sum = 0.0f;
-            for (size_t k = 0; k < inner; ++k) {
-                sum += (*this)(i, k) * other(k, j);
-            }
-            result(i, j) = sum;
+            std::cout << (*this)[i * cols + j] << " ";
         }
+        std::cout << std::endl;
     }
-    
-    return result;
 }
 
-Tensor Tensor::transpose() const {
-    Tensor result(shape_[1], shape_[0]);
-    for (size_t i = 0; i < shape_[0]; ++i) {
-        for (size_t j = 0; j < shape_[1]; ++j) {
-            result(j, i) = (*this)(i, j);
+void Tensor::set_layout(const Shape& shape, const Shape& strides, size_t offset) {
+    shape_ = shape;
+    strides_ = strides;
+    offset_ = offset;
+    size_ = shape.numel();
+
+    // Dimensions of extent 1 never move, so their stride does not matter
+    contiguous_ = true;
+    size_t expected = 1;
+    for (size_t d = shape.size(); d-- > 0;) {
+        if (shape[d] != 1 && strides[d] != expected) {
+            contiguous_ = size_ == 0;
+            break;
         }
+        expected *= shape[d];
     }
-    return result;
 }
 
-Tensor Tensor::sigmoid() const {
-    Tensor result(shape_[0], shape_[1]);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = 1.0f / (1.0f + std::exp(-data_[i]));
+void Tensor::make_contiguous() {
+    if (!contiguous_) {
+        *this = contiguous();
     }
-    return result;
 }
 
-Tensor Tensor::relu() const {
-    Tensor result(shape_[0], shape_[1]);
-    for (size_t i = 0; i < data_.size(); ++i) {
-        result.data_[i] = std::max(0.0f, data_[i]);
+size_t Tensor::index(size_t row, size_t col) const {
+    if (rank() < 2) {
+        return offset_ + (rank() == 1 ? row * strides_[0] : 0);
     }
-    return result;
+    return offset_ + row * strides_[0] + col * strides_[1];
 }
 
-void Tensor::fill(float value) {
-    for (auto& val : data_) {
-        val = value;
+size_t Tensor::linear_index(size_t index) const {
+    if (contiguous_) {
+        return offset_ + index;
+    }
+    size_t pos = offset_;
+    for (size_t d = rank(); d-- > 0;) {
+        pos += (index % shape_[d]) * strides_[d];
+        index /= shape_[d];
     }
+    return pos;
 }
 
-Tensor Tensor::sum(int axis) const {
+size_t Tensor::element_index(std::initializer_list<size_t> index) const {
+    if (index.size() != rank()) {
+        throw std::runtime_error("Tensor index does not match its rank");
+    }
+    size_t pos = offset_;
+    size_t d = 0;
+    for (size_t i : index) {
+        if (i >= shape_[d]) {
+            throw std::runtime_error("Tensor index out of range");
+        }
+        pos += i * strides_[d++];
+    }
+    return pos;
+}
+
+void matmul_into(Tensor& dst, const Tensor& a, const Tensor& b,
+                 Transpose trans_a, Transpose trans_b) {
+    if (a.rank() != 2 || b.rank() != 2) {
+        throw std::runtime_error("matmul expects 2-D tensors");
+    }
+
+    size_t rows = trans_a == Transpose::Yes ? a.cols() : a.rows();
+    size_t inner = trans_a == Transpose::Yes ? a.rows() : a.cols();
+    size_t b_rows = trans_b == Transpose::Yes ? b.cols() : b.rows();
+    size_t cols = trans_b == Transpose::Yes ? b.rows() : b.cols();
+
+    if (inner != b_rows) {
+        throw std::runtime_error("Matrix dimensions incompatible for multiplication");
+    }
+    if (&dst == &a || &dst == &b) {
+        throw std::runtime_error("matmul_into destination must not alias an operand");
+    }
+
+    Tensor a_scratch, b_scratch;
+    GemmOperand op_a = gemm_operand(a, trans_a, a_scratch);
+    GemmOperand op_b = gemm_operand(b, trans_b, b_scratch);
+
+    dst.resize(rows, cols);
+    gemm(op_a.trans, op_b.trans, rows, cols, inner,
+         op_a.data, op_a.dtype, op_a.ld,
+         op_b.data, op_b.dtype, op_b.ld,
+         dst.data(), cols);
+}
+
+void linear_into(Tensor& dst, const Tensor& weights, const Tensor& input, const Tensor& bias,
+                 Activation activation, MathPrecision precision) {
+    if (weights.rank() != 2 || input.rank() != 2) {
+        throw std::runtime_error("linear expects 2-D weights and input");
+    }
+    if (weights.cols() != input.rows()) {
+        throw std::runtime_error("Matrix dimensions incompatible for multiplication");
+    }
+    if (bias.size() != weights.rows() || bias.dtype() != DType::Float32 || !bias.is_contiguous()) {
+        throw std::runtime_error("linear bias must be a contiguous float32 tensor with one value per row");
+    }
+    if (&dst == &weights || &dst == &input || &dst == &bias) {
+        throw std::runtime_error("linear_into destination must not alias an operand");
+    }
+
+    Tensor a_scratch, b_scratch;
+    GemmOperand op_a = gemm_operand(weights, Transpose::No, a_scratch);
+    GemmOperand op_b = gemm_operand(input, Transpose::No, b_scratch);
+
+    GemmEpilogue epilogue;
+    epilogue.bias = bias.data();
+    epilogue.activation = activation;
+    epilogue.precision = precision;
+
+    const size_t rows = weights.rows();
+    const size_t cols = input.cols();
+    dst.resize(rows, cols);
+    gemm(op_a.trans, op_b.trans, rows, cols, weights.cols(),
+         op_a.data, op_a.dtype, op_a.ld,
+         op_b.data, op_b.dtype, op_b.ld,
+         dst.data(), cols, epilogue);
+}
+
+void activation_backward_into(Tensor& grad, Tensor& grad_bias, const Tensor& grad_output,
+                              const Tensor& output, Activation activation) {
+    if (grad_output.rank() != 2 || grad_output.shape() != output.shape()) {
+        throw std::runtime_error("activation_backward_into expects 2-D gradient and output of the same shape");
+    }
+    if (&grad_bias == &grad_output || &grad_bias == &output || &grad_bias == &grad) {
+        throw std::runtime_error("activation_backward_into grad_bias must not alias another argument");
+    }
+    if (activation == Activation::Identity) {
+        grad = grad_output;  // Shares the buffer
+        sum_into(grad_bias, grad, 1);
+        return;
+    }
+
+    Tensor g_scratch, y_scratch;
+    const Tensor& g = packed(grad_output, g_scratch);
+    const Tensor& y = packed(output, y_scratch);
+    const size_t rows = g.rows();
+    const size_t cols = g.cols();
+    grad.resize(rows, cols);
+    grad_bias.resize(rows, 1);
+    const auto& kernels = kernels::elementwise();
+    auto derivative = activation == Activation::Sigmoid ? kernels.sigmoid_backward : kernels.relu_backward;
+    const float* g_data = g.data();
+    const float* y_data = y.data();
+    float* out = grad.data();
+    float* bias_out = grad_bias.data();
+    // Each row is summed right after it is written, while it is in cache
+    for_each_row(rows, cols, [&](size_t i) {
+        derivative(y_data + i * cols, g_data + i * cols, out + i * cols, cols);
+        bias_out[i] = reduce_sum(out + i * cols, cols);
+    });
+}
+
+void activation_grad_into(Tensor& grad, const Tensor& grad_output, const Tensor& output, Activation activation) {
+    if (grad_output.shape() != output.shape()) {
+        throw std::runtime_error("activation_grad_into expects gradient and output of the same shape");
+    }
+    if (activation == Activation::Identity) {
+        grad = grad_output;  // Shares the buffer
+        return;
+    }
+    Tensor g_scratch, y_scratch;
+    const Tensor& g = packed(grad_output, g_scratch);
+    const Tensor& y = packed(output, y_scratch);
+    grad.resize(g.shape());
+    const auto& kernels = kernels::elementwise();
+    parallel_binary(activation == Activation::Sigmoid ? kernels.sigmoid_backward : kernels.relu_backward,
+                    y.data(), g.data(), grad.data(), g.size());
+}
+
+void convert_into(Tensor& dst, const Tensor& src, DType dtype) {
+    if (&dst == &src) {
+        if (src.dtype() != dtype) {
+            Tensor result;
+            convert_into(result, src, dtype);
+            dst = std::move(result);
+        }
+        return;
+    }
+    Tensor scratch;
+    const Tensor* s = &src;
+    if (!src.is_contiguous()) {
+        scratch = src.contiguous();
+        s = &scratch;
+    }
+    dst.resize(s->shape(), dtype);
+
+    const char* in = static_cast<const char*>(s->raw_data());
+    char* out = static_cast<char*>(dst.raw_data());
+    const DType from = s->dtype();
+    parallel_for(s->size(), ELEMENTWISE_GRAIN, [&](size_t begin, size_t end) {
+        convert_elements(in + begin * dtype_size(from), from, out + begin * dtype_size(dtype), dtype, end - begin);
+    });
+}
+
+void transpose_into(Tensor& dst, const Tensor& src) {
+    if (&dst == &src) {
+        throw std::runtime_error("transpose_into destination must not alias the source");
+    }
+    if (src.rank() != 2) {
+        throw std::runtime_error("transpose expects a 2-D tensor");
+    }
+
+    Tensor scratch;
+    const Tensor& s = packed(src, scratch);
+    size_t rows = s.rows();
+    size_t cols = s.cols();
+    dst.resize(cols, rows);
+
+    const float* in = s.data();
+    float* out = dst.data();
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            out[j * rows + i] = in[i * cols + j];
+        }
+    }
+}
+
+void sigmoid_into(Tensor& dst, const Tensor& src, MathPrecision precision) {
+    Tensor scratch;
+    const Tensor& in = packed(src, scratch);
+    dst.resize(in.shape());
+    parallel_unary(kernels::math(precision).sigmoid, in.data(), dst.data(), in.size());
+}
+
+void tanh_into(Tensor& dst, const Tensor& src, MathPrecision precision) {
+    Tensor scratch;
+    const Tensor& in = packed(src, scratch);
+    dst.resize(in.shape());
+    parallel_unary(kernels::math(precision).tanh, in.data(), dst.data(), in.size());
+}
+
+void relu_into(Tensor& dst, const Tensor& src) {
+    Tensor scratch;
+    const Tensor& in = packed(src, scratch);
+    dst.resize(in.shape());
+    parallel_unary(kernels::elementwise().relu, in.data(), dst.data(), in.size());
+}
+
+void exp_into(Tensor& dst, const Tensor& src, MathPrecision precision) {
+    Tensor scratch;
+    const Tensor& in = packed(src, scratch);
+    dst.resize(in.shape());
+    parallel_unary(kernels::math(precision).exp, in.data(), dst.data(), in.size());
+}
+
+void log_into(Tensor& dst, const Tensor& src, MathPrecision precision) {
+    Tensor scratch;
+    const Tensor& in = packed(src, scratch);
+    dst.resize(in.shape());
+    parallel_unary(kernels::math(precision).log, in.data(), dst.data(), in.size());
+}
+
+void sum_into(Tensor& dst, const Tensor& src, int axis) {
+    Tensor scratch;
+    const Tensor& s = reduction_source(dst, src, axis, scratch, "sum");
+    const float* in = s.data();
+
     if (axis == -1) {
         // Sum all elements
-        float total = 0.0f;
-        for (const auto& val : data_) {
-            total += val;
+        const float total = reduce_sum(in, s.size());
+        dst.resize(1, 1);
+        dst[0] = total;
+        return;
+    }
+
+    const size_t rows = s.rows();
+    const size_t cols = s.cols();
+    if (axis == 0) {
+        // Sum along rows (reduce rows), streaming each row segment in order
+        dst.resize(1, cols);
+        float* out = dst.data();
+        if (rows == 0) {
+            std::fill(out, out + cols, 0.0f);
+            return;
         }
-        return Tensor({{total}}, {1, 1});
-    } else if (axis == 0) {
-        // Sum along rows (reduce rows)
-        Tensor result(1, shape_[1]);
-        for (size_t j = 0; j < shape_[1]; ++j) {
-            float sum = 0.0f;
-            for (size_t i = 0; i < shape_[0]; ++i) {
-                sum += (*this)(i, j);
-            }
-            result(0, j) = sum;
+        size_t levels = 0;
+        for (size_t r = rows; r > COLUMN_BLOCK_ROWS; r -= r / 2) {
+            ++levels;
         }
-        return result;
+        for_each_column_strip(rows, cols, [&](size_t j0, size_t w) {
+            if (column_scratch.size() < levels * COLUMN_STRIP) {
+                column_scratch.resize(levels * COLUMN_STRIP);
+            }
+            column_sums(in + j0, cols, rows, w, out + j0, column_scratch.data());
+        });
     } else { // axis == 1
         // Sum along columns (reduce columns)
-        Tensor result(shape_[0], 1);
-        for (size_t i = 0; i < shape_[0]; ++i) {
-            float sum = 0.0f;
-            for (size_t j = 0; j < shape_[1]; ++j) {
-                sum += (*this)(i, j);
-            }
-            result(i, 0) = sum;
-        }
-        return result;
+        dst.resize(rows, 1);
+        float* out = dst.data();
+        for_each_row(rows, cols, [&](size_t i) { out[i] = reduce_sum(in + i * cols, cols); });
     }
 }
 
-void Tensor::print() const {
-    for (size_t i = 0; i < shape_[0]; ++i) {
-        for (size_t j = 0; j < shape_[1]; ++j) {
-            std::cout << (*this)(i, j) << " ";
-        }
-        std::cout << std::endl;
+void mean_into(Tensor& dst, const Tensor& src, int axis) {
+    sum_into(dst, src, axis);
+    const size_t count = axis == -1 ? src.size() : axis == 0 ? src.rows() : src.cols();
+    float* out = dst.data();
+    for (size_t i = 0; i < dst.size(); ++i) {
+        out[i] /= static_cast<float>(count);
     }
 }
 
-void Tensor::reshape(const std::vector<size_t>& new_shape) {
-    if (new_shape[0] * new_shape[1] != data_.size()) {
-        throw std::runtime_error("New shape incompatible with data size");
+void max_into(Tensor& dst, const Tensor& src, int axis) {
+    Tensor scratch;
+    const Tensor& s = reduction_source(dst, src, axis, scratch, "max");
+    const float* in = s.data();
+    const size_t count = axis == -1 ? s.size() : axis == 0 ? s.rows() : s.cols();
+    if (count == 0) {
+        throw std::runtime_error("max of an empty tensor");
     }
-    shape_ = new_shape;
-}
 
-size_t Tensor::index(size_t row, size_t col) const {
-    return row * shape_[1] + col;
+    if (axis == -1) {
+        const float result = reduce_max(in, s.size());
+        dst.resize(1, 1);
+        dst[0] = result;
+        return;
+    }
+
+    const size_t rows = s.rows();
+    const size_t cols = s.cols();
+    if (axis == 0) {
+        dst.resize(1, cols);
+        float* out = dst.data();
+        const auto& kernels = kernels::elementwise();
+        for_each_column_strip(rows, cols, [&](size_t j0, size_t w) {
+            kernels.fill(out + j0, -std::numeric_limits<float>::infinity(), w);
+            for (size_t r = 0; r < rows; ++r) {
+                kernels.max(in + r * cols + j0, out + j0, out + j0, w);
+            }
+        });
+    } else { // axis == 1
+        dst.resize(rows, 1);
+        float* out = dst.data();
+        for_each_row(rows, cols, [&](size_t i) { out[i] = reduce_max(in + i * cols, cols); });
+    }
 }
 
-Tensor operator*(float scalar, const Tensor& tensor) {
-    return tensor * scalar;
+void argmax_into(Tensor& dst, const Tensor& src, int axis) {
+    Tensor scratch;
+    const Tensor& s = reduction_source(dst, src, axis, scratch, "argmax");
+    const float* in = s.data();
+    const size_t count = axis == -1 ? s.size() : axis == 0 ? s.rows() : s.cols();
+    if (count == 0) {
+        throw std::runtime_error("argmax of an empty tensor");
+    }
+
+    if (axis == -1) {
+        const size_t index = reduce_argmax(in, s.size());
+        dst.resize(1, 1);
+        dst[0] = static_cast<float>(index);
+        return;
+    }
+
+    const size_t rows = s.rows();
+    const size_t cols = s.cols();
+    if (axis == 0) {
+        dst.resize(1, cols);
+        float* out = dst.data();
+        const auto& kernels = kernels::elementwise();
+        for_each_column_strip(rows, cols, [&](size_t j0, size_t w) {
+            // Column maxima of the strip, then the first row reaching each
+            float best[COLUMN_STRIP];
+            size_t index[COLUMN_STRIP];
+            kernels.fill(best, -std::numeric_limits<float>::infinity(), w);
+            for (size_t r = 0; r < rows; ++r) {
+                kernels.max(in + r * cols + j0, best, best, w);
+            }
+            std::fill(index, index + w, rows);
+            size_t remaining = w;
+            for (size_t r = 0; r < rows && remaining > 0; ++r) {
+                const float* row = in + r * cols + j0;
+                for (size_t j = 0; j < w; ++j) {
+                    if (index[j] == rows && row[j] == best[j]) {
+                        index[j] = r;
+                        --remaining;
+                    }
+                }
+            }
+            for (size_t j = 0; j < w; ++j) {
+                out[j0 + j] = static_cast<float>(index[j] == rows ? 0 : index[j]);  // All NaN
+            }
+        });
+    } else { // axis == 1
+        dst.resize(rows, 1);
+        float* out = dst.data();
+        for_each_row(rows, cols, [&](size_t i) { out[i] = static_cast<float>(reduce_argmax(in + i * cols, cols)); });
+    }
 }
 
-} // namespace nn
\ No newline at end of file
+} // namespace nn
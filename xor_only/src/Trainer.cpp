@@ -0,0 +1,99 @@
+#include "Trainer.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace nn {
+
+namespace {
+
+// dst (rows x count) = columns order[0..count) of src (rows x n)
+void gather_columns(Tensor& dst, const Tensor& src, const size_t* order, size_t count) {
+    const size_t rows = src.rows();
+    const size_t n = src.cols();
+    dst.resize(rows, count);
+    const float* in = src.data();
+    float* out = dst.data();
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t j = 0; j < count; ++j) {
+            out[r * count + j] = in[r * n + order[j]];
+        }
+    }
+}
+
+} // namespace
+
+Trainer::Trainer(Network& network, size_t batch_size) : network_(network), batch_size_(1) {
+    set_batch_size(batch_size);
+}
+
+void Trainer::set_batch_size(size_t batch_size) {
+    if (batch_size == 0) {
+        throw std::runtime_error("Trainer batch size must be positive");
+    }
+    batch_size_ = batch_size;
+}
+
+void Trainer::set_shuffle(bool shuffle, uint32_t seed) {
+    shuffle_ = shuffle;
+    gen_.seed(seed);
+}
+
+void Trainer::train_epoch(const Tensor& inputs, const Tensor& targets, float learning_rate) {
+    run_epoch(inputs, targets, nullptr, learning_rate);
+}
+
+float Trainer::train_epoch(const Tensor& inputs, const Tensor& targets, Loss& loss, float learning_rate) {
+    return run_epoch(inputs, targets, &loss, learning_rate);
+}
+
+float Trainer::run_epoch(const Tensor& inputs, const Tensor& targets, Loss* loss, float learning_rate) {
+    if (inputs.rank() != 2 || targets.rank() != 2 || inputs.cols() != targets.cols()) {
+        throw std::runtime_error("Trainer expects 2-D inputs and targets with one sample per column");
+    }
+    const Tensor x = inputs.to(DType::Float32).contiguous();
+    const Tensor t = targets.to(DType::Float32).contiguous();
+    const size_t samples = x.cols();
+
+    order_.resize(samples);
+    std::iota(order_.begin(), order_.end(), size_t(0));
+    if (shuffle_) {
+        std::shuffle(order_.begin(), order_.end(), gen_);
+    }
+
+    double total = 0.0;
+    for (size_t start = 0; start < samples; start += batch_size_) {
+        const size_t count = std::min(batch_size_, samples - start);
+        gather_columns(batch_input_, x, order_.data() + start, count);
+        gather_columns(batch_target_, t, order_.data() + start, count);
+        if (loss) {
+            // Weighted by the batch size, so a partial last batch counts less
+            total += static_cast<double>(network_.train_step(batch_input_, batch_target_, *loss, learning_rate)) * count;
+        } else {
+            network_.train_step(batch_input_, batch_target_, learning_rate);
+        }
+    }
+    return samples == 0 ? 0.0f : static_cast<float>(total / samples);
+}
+
+Tensor stack_columns(const std::vector<Tensor>& samples) {
+    if (samples.empty()) {
+        return Tensor(0, 0);
+    }
+    const size_t rows = samples.front().size();
+    Tensor result(rows, samples.size());
+    float* out = result.data();
+    for (size_t j = 0; j < samples.size(); ++j) {
+        if (samples[j].size() != rows || samples[j].cols() != 1) {
+            throw std::runtime_error("stack_columns expects samples of equal shape (features, 1)");
+        }
+        const Tensor sample = samples[j].to(DType::Float32).contiguous();
+        const float* in = sample.data();
+        for (size_t r = 0; r < rows; ++r) {
+            out[r * samples.size() + j] = in[r];
+        }
+    }
+    return result;
+}
+
+} // namespace nn
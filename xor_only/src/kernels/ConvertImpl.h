@@ -0,0 +1,71 @@
+#ifndef NN_KERNELS_CONVERT_IMPL_H
+#define NN_KERNELS_CONVERT_IMPL_H
+
+// Conversions between float32 and the 16-bit storage types. Half precision
+// uses the F16C instructions where the translation unit enables them; the
+// portable loops use the scalar conversions from Half.h, which produce the
+// same bits.
+
+#include "Half.h"
+#include "Kernels.h"
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace nn {
+namespace kernels {
+namespace {
+
+void bf16_to_float_loop(const uint16_t* in, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = bf16_to_float(in[i]);
+    }
+}
+
+void float_to_bf16_loop(const float* in, uint16_t* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = float_to_bf16(in[i]);
+    }
+}
+
+void fp16_to_float_loop(const uint16_t* in, float* out, size_t n) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = fp16_to_float(in[i]);
+    }
+}
+
+void float_to_fp16_loop(const float* in, uint16_t* out, size_t n) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+    }
+#endif
+    for (; i < n; ++i) {
+        out[i] = float_to_fp16(in[i]);
+    }
+}
+
+constexpr ConversionKernels make_conversions() {
+    return ConversionKernels{
+        &bf16_to_float_loop,
+        &float_to_bf16_loop,
+        &fp16_to_float_loop,
+        &float_to_fp16_loop,
+    };
+}
+
+} // namespace
+} // namespace kernels
+} // namespace nn
+
+#endif // NN_KERNELS_CONVERT_IMPL_H
@@ -0,0 +1,135 @@
+#ifndef NN_KERNELS_ELEMENTWISE_IMPL_H
+#define NN_KERNELS_ELEMENTWISE_IMPL_H
+
+// Element-wise kernels written once against the Vec wrappers and
+// instantiated by each ISA translation unit. Leftover elements after the
+// last full register go through VecScalar, so every variant computes
+// exactly the same values as the scalar reference.
+
+#include "Kernels.h"
+#include "Vec.h"
+
+namespace nn {
+namespace kernels {
+namespace {
+
+struct AddOp {
+    template <typename V>
+    static typename V::reg apply(typename V::reg a, typename V::reg b) { return V::add(a, b); }
+};
+
+struct SubOp {
+    template <typename V>
+    static typename V::reg apply(typename V::reg a, typename V::reg b) { return V::sub(a, b); }
+};
+
+struct MulOp {
+    template <typename V>
+    static typename V::reg apply(typename V::reg a, typename V::reg b) { return V::mul(a, b); }
+};
+
+// Returns b when either operand is NaN
+struct MaxOp {
+    template <typename V>
+    static typename V::reg apply(typename V::reg a, typename V::reg b) { return V::max(a, b); }
+};
+
+// Gradient g through a sigmoid with output y, in the operation order of
+// the Sigmoid layer's backward expression
+struct SigmoidBackwardOp {
+    template <typename V>
+    static typename V::reg apply(typename V::reg y, typename V::reg g) {
+        return V::mul(g, V::mul(y, V::sub(V::set1(1.0f), y)));
+    }
+};
+
+// Passes g where the relu output y is positive
+struct ReluBackwardOp {
+    template <typename V>
+    static typename V::reg apply(typename V::reg y, typename V::reg g) {
+        return V::select(V::lt(V::zero(), y), g, V::zero());
+    }
+};
+
+template <typename V, typename Op>
+void binary(const float* a, const float* b, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V::store(out + i, Op::template apply<V>(V::load(a + i), V::load(b + i)));
+    }
+    for (; i < n; ++i) {
+        out[i] = Op::template apply<VecScalar>(a[i], b[i]);
+    }
+}
+
+template <typename V, typename Op>
+void binary_scalar(const float* a, float scalar, float* out, size_t n) {
+    const typename V::reg s = V::set1(scalar);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V::store(out + i, Op::template apply<V>(V::load(a + i), s));
+    }
+    for (; i < n; ++i) {
+        out[i] = Op::template apply<VecScalar>(a[i], scalar);
+    }
+}
+
+template <typename V>
+void fill(float* out, float value, size_t n) {
+    const typename V::reg v = V::set1(value);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V::store(out + i, v);
+    }
+    for (; i < n; ++i) {
+        out[i] = value;
+    }
+}
+
+template <typename V>
+void relu(const float* a, float* out, size_t n) {
+    const typename V::reg zero = V::zero();
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V::store(out + i, V::max(V::load(a + i), zero));
+    }
+    for (; i < n; ++i) {
+        out[i] = VecScalar::max(a[i], 0.0f);
+    }
+}
+
+// Separate multiply and add (no FMA) keeps every variant bit-identical
+template <typename V>
+void axpy(float alpha, const float* x, float* y, size_t n) {
+    const typename V::reg a = V::set1(alpha);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V::store(y + i, V::add(V::load(y + i), V::mul(a, V::load(x + i))));
+    }
+    for (; i < n; ++i) {
+        y[i] = y[i] + alpha * x[i];
+    }
+}
+
+template <typename V>
+constexpr ElementwiseKernels make_elementwise() {
+    return ElementwiseKernels{
+        &binary<V, AddOp>,
+        &binary<V, SubOp>,
+        &binary<V, MulOp>,
+        &binary<V, MaxOp>,
+        &binary_scalar<V, AddOp>,
+        &binary_scalar<V, MulOp>,
+        &fill<V>,
+        &relu<V>,
+        &axpy<V>,
+        &binary<V, SigmoidBackwardOp>,
+        &binary<V, ReluBackwardOp>,
+    };
+}
+
+} // namespace
+} // namespace kernels
+} // namespace nn
+
+#endif // NN_KERNELS_ELEMENTWISE_IMPL_H
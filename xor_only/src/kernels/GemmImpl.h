@@ -0,0 +1,98 @@
+#ifndef NN_KERNELS_GEMM_IMPL_H
+#define NN_KERNELS_GEMM_IMPL_H
+
+// GEMM register-tile kernel written once against the Vec wrappers. Each
+// element of C is summed in increasing k with separate multiplies and adds,
+// so every variant and every tile shape matches the scalar reference bit
+// for bit.
+
+#include "Kernels.h"
+#include "Vec.h"
+
+namespace nn {
+namespace kernels {
+namespace {
+
+// C tile (rows x cols) = (accumulate ? C tile : 0) + a * b, plus bias[i] on
+// row i. An edge tile smaller than MR x NR is computed in a local buffer so
+// the accumulators always cover whole registers.
+template <typename V, size_t MR, size_t NR>
+void gemm_tile(size_t kc, const float* a, const float* b, float* c, size_t ldc,
+               size_t rows, size_t cols, bool accumulate, const float* bias) {
+    static_assert(NR % V::width == 0, "Tile columns must fill whole registers");
+    constexpr size_t regs = NR / V::width;
+    using reg = typename V::reg;
+
+    const bool full = rows == MR && cols == NR;
+    float edge[MR * NR];
+    float* out = c;
+    size_t ld = ldc;
+    if (!full) {
+        out = edge;
+        ld = NR;
+        if (accumulate) {
+            std::fill(edge, edge + MR * NR, 0.0f);
+            for (size_t i = 0; i < rows; ++i) {
+                std::copy(c + i * ldc, c + i * ldc + cols, edge + i * NR);
+            }
+        }
+    }
+
+    reg acc[MR][regs];
+    for (size_t i = 0; i < MR; ++i) {
+        for (size_t k = 0; k < regs; ++k) {
+            acc[i][k] = accumulate ? V::load(out + i * ld + k * V::width) : V::zero();
+        }
+    }
+
+    for (size_t p = 0; p < kc; ++p) {
+        reg bv[regs];
+        for (size_t k = 0; k < regs; ++k) {
+            bv[k] = V::load(b + k * V::width);
+        }
+        for (size_t i = 0; i < MR; ++i) {
+            const reg ai = V::set1(a[i]);
+            for (size_t k = 0; k < regs; ++k) {
+                acc[i][k] = V::add(acc[i][k], V::mul(ai, bv[k]));
+            }
+        }
+        a += MR;
+        b += NR;
+    }
+
+    if (bias) {
+        for (size_t i = 0; i < MR; ++i) {
+            if (i < rows) {
+                const reg shift = V::set1(bias[i]);
+                for (size_t k = 0; k < regs; ++k) {
+                    acc[i][k] = V::add(acc[i][k], shift);
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < MR; ++i) {
+        for (size_t k = 0; k < regs; ++k) {
+            V::store(out + i * ld + k * V::width, acc[i][k]);
+        }
+    }
+
+    if (!full) {
+        for (size_t i = 0; i < rows; ++i) {
+            std::copy(edge + i * NR, edge + i * NR + cols, c + i * ldc);
+        }
+    }
+}
+
+// Each instruction set picks tiles whose accumulators, one row of b and a
+// broadcast of a fit in its registers
+template <typename V, size_t MR, size_t NR>
+constexpr GemmTile make_gemm_tile() {
+    return GemmTile{MR, NR, &gemm_tile<V, MR, NR>};
+}
+
+} // namespace
+} // namespace kernels
+} // namespace nn
+
+#endif // NN_KERNELS_GEMM_IMPL_H
@@ -0,0 +1,31 @@
+#include "ConvertImpl.h"
+#include "ElementwiseImpl.h"
+#include "GemmImpl.h"
+#include "MathImpl.h"
+#include "OptimizerImpl.h"
+#include "QuantizeImpl.h"
+#include "ReductionImpl.h"
+#include "SparseImpl.h"
+#include "Tables.h"
+
+#if defined(NN_X86_KERNELS) && defined(__AVX2__)
+
+namespace nn {
+namespace kernels {
+namespace avx2 {
+
+const ElementwiseKernels elementwise_table = make_elementwise<VecAVX2>();
+const ReductionKernels reduction_table = make_reductions<VecAVX2>();
+const ConversionKernels conversion_table = make_conversions();
+const QuantizedKernels quantized_table = make_quantized(&quant_tile_avx2, &quantize_sse2);
+const SparseKernels sparse_table = make_sparse<VecAVX2>();
+const GemmKernels gemm_table = {make_gemm_tile<VecAVX2, 6, 16>(), make_gemm_tile<VecAVX2, 12, 8>()};
+const OptimizerKernels optimizer_table = make_optimizer<VecAVX2>();
+const MathKernels math_accurate_table = make_math<VecAVX2, true>();
+const MathKernels math_fast_table = make_math<VecAVX2, false>();
+
+} // namespace avx2
+} // namespace kernels
+} // namespace nn
+
+#endif
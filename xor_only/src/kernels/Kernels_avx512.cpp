@@ -0,0 +1,33 @@
+#include "ConvertImpl.h"
+#include "ElementwiseImpl.h"
+#include "GemmImpl.h"
+#include "MathImpl.h"
+#include "OptimizerImpl.h"
+#include "QuantizeImpl.h"
+#include "ReductionImpl.h"
+#include "SparseImpl.h"
+#include "Tables.h"
+
+#if defined(NN_X86_KERNELS) && defined(__AVX512F__)
+
+namespace nn {
+namespace kernels {
+namespace avx512 {
+
+const ElementwiseKernels elementwise_table = make_elementwise<VecAVX512>();
+const ReductionKernels reduction_table = make_reductions<VecAVX512>();
+const ConversionKernels conversion_table = make_conversions();
+const QuantizedKernels quantized_table = make_quantized(&quant_tile_avx512, &quantize_sse2);
+const QuantizedKernels quantized_vnni_table = make_quantized(&quant_tile_vnni, &quantize_sse2);
+const SparseKernels sparse_table = make_sparse<VecAVX512>();
+// The narrow tile uses 8-wide registers; without AVX-512VL only 16 of them exist
+const GemmKernels gemm_table = {make_gemm_tile<VecAVX512, 12, 32>(), make_gemm_tile<VecAVX2, 12, 8>()};
+const OptimizerKernels optimizer_table = make_optimizer<VecAVX512>();
+const MathKernels math_accurate_table = make_math<VecAVX512, true>();
+const MathKernels math_fast_table = make_math<VecAVX512, false>();
+
+} // namespace avx512
+} // namespace kernels
+} // namespace nn
+
+#endif
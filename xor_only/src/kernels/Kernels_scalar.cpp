@@ -0,0 +1,28 @@
+#include "ConvertImpl.h"
+#include "ElementwiseImpl.h"
+#include "GemmImpl.h"
+#include "MathImpl.h"
+#include "OptimizerImpl.h"
+#include "QuantizeImpl.h"
+#include "ReductionImpl.h"
+#include "SparseImpl.h"
+#include "Tables.h"
+
+namespace nn {
+namespace kernels {
+namespace scalar {
+
+const ElementwiseKernels elementwise_table = make_elementwise<VecScalar>();
+const ReductionKernels reduction_table = make_reductions<VecScalar>();
+const ConversionKernels conversion_table = make_conversions();
+const QuantizedKernels quantized_table = make_quantized(&quant_tile_loop, &quantize_loop);
+const SparseKernels sparse_table = make_sparse<VecScalar>();
+// Without SIMD a narrower tile saves nothing
+const GemmKernels gemm_table = {make_gemm_tile<VecScalar, 6, 8>(), make_gemm_tile<VecScalar, 6, 8>()};
+const OptimizerKernels optimizer_table = make_optimizer<VecScalar>();
+const MathKernels math_accurate_table = make_math<VecScalar, true>();
+const MathKernels math_fast_table = make_math<VecScalar, false>();
+
+} // namespace scalar
+} // namespace kernels
+} // namespace nn
@@ -0,0 +1,32 @@
+#include "ConvertImpl.h"
+#include "ElementwiseImpl.h"
+#include "GemmImpl.h"
+#include "MathImpl.h"
+#include "OptimizerImpl.h"
+#include "QuantizeImpl.h"
+#include "ReductionImpl.h"
+#include "SparseImpl.h"
+#include "Tables.h"
+
+#if defined(NN_X86_KERNELS) && defined(__SSE2__)
+
+namespace nn {
+namespace kernels {
+namespace sse2 {
+
+const ElementwiseKernels elementwise_table = make_elementwise<VecSSE2>();
+const ReductionKernels reduction_table = make_reductions<VecSSE2>();
+const ConversionKernels conversion_table = make_conversions();
+// SSE2 has no byte multiply-add; SSSE3 brought pmaddubsw
+const QuantizedKernels quantized_table = make_quantized(&quant_tile_loop, &quantize_sse2);
+const SparseKernels sparse_table = make_sparse<VecSSE2>();
+const GemmKernels gemm_table = {make_gemm_tile<VecSSE2, 6, 8>(), make_gemm_tile<VecSSE2, 12, 4>()};
+const OptimizerKernels optimizer_table = make_optimizer<VecSSE2>();
+const MathKernels math_accurate_table = make_math<VecSSE2, true>();
+const MathKernels math_fast_table = make_math<VecSSE2, false>();
+
+} // namespace sse2
+} // namespace kernels
+} // namespace nn
+
+#endif
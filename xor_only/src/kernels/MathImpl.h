@@ -0,0 +1,220 @@
+#ifndef NN_KERNELS_MATH_IMPL_H
+#define NN_KERNELS_MATH_IMPL_H
+
+// Polynomial transcendental kernels written once against the Vec wrappers.
+// The accurate tier follows the Cephes single-precision algorithms; the
+// fast tier trades range reduction precision and polynomial degree for
+// throughput.
+
+#include "Kernels.h"
+#include "Vec.h"
+
+namespace nn {
+namespace kernels {
+namespace {
+
+template <typename V>
+inline typename V::reg pow2i(typename V::ireg n) {
+    return V::as_float(V::template shl<23>(V::iadd(n, V::iset1(127))));
+}
+
+template <typename V, bool Accurate>
+inline typename V::reg exp_reg(typename V::reg x) {
+    using reg = typename V::reg;
+    const reg log2e = V::set1(1.44269504088896341f);
+    const reg one = V::set1(1.0f);
+
+    if (Accurate) {
+        const reg lo = V::set1(-87.3365447505f);  // ln(FLT_MIN)
+        const reg hi = V::set1(88.7228391117f);   // ln(FLT_MAX)
+        const reg xc = V::min(V::max(x, lo), hi);
+
+        // Cody-Waite reduction: x = n * ln2 + r, |r| <= ln2 / 2
+        const typename V::ireg n = V::round_int(V::mul(xc, log2e));
+        const reg nf = V::to_float(n);
+        reg r = V::fmadd(nf, V::set1(-0.693359375f), xc);
+        r = V::fmadd(nf, V::set1(2.12194440e-4f), r);
+
+        reg p = V::set1(1.9875691500e-4f);
+        p = V::fmadd(p, r, V::set1(1.3981999507e-3f));
+        p = V::fmadd(p, r, V::set1(8.3334519073e-3f));
+        p = V::fmadd(p, r, V::set1(4.1665795894e-2f));
+        p = V::fmadd(p, r, V::set1(1.6666665459e-1f));
+        p = V::fmadd(p, r, V::set1(5.0000001201e-1f));
+        reg y = V::fmadd(p, V::mul(r, r), V::add(r, one));
+
+        // n reaches 128 near FLT_MAX, so scale in two halves
+        const typename V::ireg n1 = V::template sra<1>(n);
+        y = V::mul(V::mul(y, pow2i<V>(n1)), pow2i<V>(V::isub(n, n1)));
+
+        y = V::select(V::lt(x, lo), V::zero(), y);
+        y = V::select(V::lt(hi, x), V::set1(HUGE_VALF), y);
+        return V::select(V::is_nan(x), x, y);
+    }
+
+    const reg xc = V::min(V::max(x, V::set1(-87.0f)), V::set1(88.3762626647949f));
+    const typename V::ireg n = V::round_int(V::mul(xc, log2e));
+    const reg r = V::fmadd(V::to_float(n), V::set1(-0.693147180559945f), xc);
+
+    reg p = V::set1(1.0f / 24.0f);
+    p = V::fmadd(p, r, V::set1(1.0f / 6.0f));
+    p = V::fmadd(p, r, V::set1(0.5f));
+    p = V::fmadd(p, r, one);
+    p = V::fmadd(p, r, one);
+    return V::mul(p, pow2i<V>(n));
+}
+
+// 1 / d: exact division for Accurate, refined hardware estimate for Fast
+template <typename V, bool Accurate>
+inline typename V::reg reciprocal(typename V::reg d) {
+    if (Accurate) {
+        return V::div(V::set1(1.0f), d);
+    }
+    const typename V::reg r = V::rcp(d);
+    return V::mul(r, V::sub(V::set1(2.0f), V::mul(d, r)));
+}
+
+template <typename V, bool Accurate>
+inline typename V::reg sigmoid_reg(typename V::reg x) {
+    const typename V::reg e = exp_reg<V, Accurate>(V::sub(V::zero(), x));
+    return reciprocal<V, Accurate>(V::add(V::set1(1.0f), e));
+}
+
+template <typename V, bool Accurate>
+inline typename V::reg tanh_reg(typename V::reg x) {
+    using reg = typename V::reg;
+    const reg sign_mask = V::as_float(V::iset1(static_cast<int32_t>(0x80000000u)));
+    const reg sign = V::bit_and(x, sign_mask);
+    const reg ax = V::bit_xor(x, sign);
+
+    // Small inputs: odd polynomial avoids cancellation in 1 - 2 / (e + 1)
+    const reg z = V::mul(x, x);
+    reg p = V::set1(-5.70498872745e-3f);
+    p = V::fmadd(p, z, V::set1(2.06390887954e-2f));
+    p = V::fmadd(p, z, V::set1(-5.37397155531e-2f));
+    p = V::fmadd(p, z, V::set1(1.33314422036e-1f));
+    p = V::fmadd(p, z, V::set1(-3.33332819422e-1f));
+    const reg small = V::fmadd(V::mul(p, z), x, x);
+
+    const reg e = exp_reg<V, Accurate>(V::add(ax, ax));
+    const reg t = V::sub(V::set1(1.0f),
+                         V::mul(V::set1(2.0f), reciprocal<V, Accurate>(V::add(e, V::set1(1.0f)))));
+    const reg large = V::bit_or(t, sign);
+
+    return V::select(V::lt(ax, V::set1(0.625f)), small, large);
+}
+
+template <typename V, bool Accurate>
+inline typename V::reg log_reg(typename V::reg x) {
+    using reg = typename V::reg;
+    const reg one = V::set1(1.0f);
+    const reg zero = V::zero();
+    reg xs = x;
+    reg e_bias = zero;
+
+    if (Accurate) {
+        // Scale subnormals into the normal range first
+        const typename V::mask subnormal = V::lt(x, V::set1(1.17549435e-38f));
+        xs = V::select(subnormal, V::mul(x, V::set1(8388608.0f)), x);
+        e_bias = V::select(subnormal, V::set1(23.0f), zero);
+    }
+
+    // x = m * 2^e with m in [0.5, 1)
+    const typename V::ireg bits = V::as_int(xs);
+    reg e = V::sub(V::to_float(V::isub(V::template sra<23>(bits), V::iset1(126))), e_bias);
+    reg m = V::bit_or(V::bit_and(xs, V::as_float(V::iset1(static_cast<int32_t>(0x807fffffu)))),
+                      V::set1(0.5f));
+
+    // Move m into [sqrt(0.5), sqrt(2))
+    const typename V::mask below = V::lt(m, V::set1(0.707106781186547524f));
+    e = V::sub(e, V::select(below, one, zero));
+    m = V::add(m, V::select(below, m, zero));
+
+    reg y;
+    if (Accurate) {
+        m = V::sub(m, one);
+        const reg z = V::mul(m, m);
+        reg p = V::set1(7.0376836292e-2f);
+        p = V::fmadd(p, m, V::set1(-1.1514610310e-1f));
+        p = V::fmadd(p, m, V::set1(1.1676998740e-1f));
+        p = V::fmadd(p, m, V::set1(-1.2420140846e-1f));
+        p = V::fmadd(p, m, V::set1(1.4249322787e-1f));
+        p = V::fmadd(p, m, V::set1(-1.6668057665e-1f));
+        p = V::fmadd(p, m, V::set1(2.0000714765e-1f));
+        p = V::fmadd(p, m, V::set1(-2.4999993993e-1f));
+        p = V::fmadd(p, m, V::set1(3.3333331174e-1f));
+        y = V::mul(V::mul(p, m), z);
+        y = V::fmadd(e, V::set1(-2.12194440e-4f), y);
+        y = V::fmadd(z, V::set1(-0.5f), y);
+        y = V::add(m, y);
+        y = V::fmadd(e, V::set1(0.693359375f), y);
+    } else {
+        // log(m) = 2 * atanh(s), s = (m - 1) / (m + 1), |s| < 0.172
+        const reg s = V::mul(V::sub(m, one), reciprocal<V, false>(V::add(m, one)));
+        const reg s2 = V::mul(s, s);
+        reg p = V::fmadd(s2, V::set1(2.0f / 5.0f), V::set1(2.0f / 3.0f));
+        p = V::fmadd(p, s2, V::set1(2.0f));
+        y = V::fmadd(e, V::set1(0.693147180559945f), V::mul(p, s));
+    }
+
+    y = V::select(V::le(x, zero), V::set1(-HUGE_VALF), y);
+    y = V::select(V::lt(x, zero), V::set1(NAN), y);
+    y = V::select(V::eq(x, V::set1(HUGE_VALF)), x, y);
+    return V::select(V::is_nan(x), x, y);
+}
+
+template <bool Accurate>
+struct ExpOp {
+    template <typename V>
+    static typename V::reg apply(typename V::reg x) { return exp_reg<V, Accurate>(x); }
+};
+
+template <bool Accurate>
+struct LogOp {
+    template <typename V>
+    static typename V::reg apply(typename V::reg x) { return log_reg<V, Accurate>(x); }
+};
+
+template <bool Accurate>
+struct SigmoidOp {
+    template <typename V>
+    static typename V::reg apply(typename V::reg x) { return sigmoid_reg<V, Accurate>(x); }
+};
+
+template <bool Accurate>
+struct TanhOp {
+    template <typename V>
+    static typename V::reg apply(typename V::reg x) { return tanh_reg<V, Accurate>(x); }
+};
+
+// Leftover elements are padded into one full register so the tail gets the
+// same rounding as the body.
+template <typename V, typename Op>
+void unary(const float* in, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        V::store(out + i, Op::template apply<V>(V::load(in + i)));
+    }
+    if (i < n) {
+        float buffer[V::width] = {};
+        std::copy(in + i, in + n, buffer);
+        V::store(buffer, Op::template apply<V>(V::load(buffer)));
+        std::copy(buffer, buffer + (n - i), out + i);
+    }
+}
+
+template <typename V, bool Accurate>
+constexpr MathKernels make_math() {
+    return MathKernels{
+        &unary<V, ExpOp<Accurate>>,
+        &unary<V, LogOp<Accurate>>,
+        &unary<V, SigmoidOp<Accurate>>,
+        &unary<V, TanhOp<Accurate>>,
+    };
+}
+
+} // namespace
+} // namespace kernels
+} // namespace nn
+
+#endif // NN_KERNELS_MATH_IMPL_H
@@ -0,0 +1,115 @@
+#ifndef NN_KERNELS_OPTIMIZER_IMPL_H
+#define NN_KERNELS_OPTIMIZER_IMPL_H
+
+// Fused parameter updates written once against the Vec wrappers. Each
+// element is read and written once per step, with the parameter, gradient
+// and optimizer state updated together. There is no FMA and the square
+// root is correctly rounded, so every variant matches the scalar reference.
+
+#include "Kernels.h"
+#include "Vec.h"
+
+namespace nn {
+namespace kernels {
+namespace {
+
+// Updates element i (a full register of them for SIMD V)
+template <typename V, bool Momentum, bool Nesterov, bool Decay>
+void sgd_at(const float* g, float* w, float* velocity, const SgdStep& s, size_t i) {
+    using reg = typename V::reg;
+    const reg weight = V::load(w + i);
+    reg grad = V::load(g + i);
+    if (Decay) {
+        grad = V::add(grad, V::mul(V::set1(s.weight_decay), weight));
+    }
+    if (Momentum) {
+        const reg mu = V::set1(s.momentum);
+        const reg v = V::add(V::mul(mu, V::load(velocity + i)), grad);
+        V::store(velocity + i, v);
+        grad = Nesterov ? V::add(grad, V::mul(mu, v)) : v;
+    }
+    V::store(w + i, V::sub(weight, V::mul(V::set1(s.learning_rate), grad)));
+}
+
+template <typename V, bool Momentum, bool Nesterov, bool Decay>
+void sgd_loop(const float* g, float* w, float* velocity, size_t n, const SgdStep& s) {
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        sgd_at<V, Momentum, Nesterov, Decay>(g, w, velocity, s, i);
+    }
+    for (; i < n; ++i) {
+        sgd_at<VecScalar, Momentum, Nesterov, Decay>(g, w, velocity, s, i);
+    }
+}
+
+// Picks the loop without the terms that are zero in this step
+template <typename V>
+void sgd(const float* g, float* w, float* velocity, size_t n, const SgdStep& s) {
+    const bool decay = s.weight_decay != 0.0f;
+    if (s.momentum == 0.0f) {
+        (decay ? &sgd_loop<V, false, false, true> : &sgd_loop<V, false, false, false>)(g, w, velocity, n, s);
+    } else if (s.nesterov) {
+        (decay ? &sgd_loop<V, true, true, true> : &sgd_loop<V, true, true, false>)(g, w, velocity, n, s);
+    } else {
+        (decay ? &sgd_loop<V, true, false, true> : &sgd_loop<V, true, false, false>)(g, w, velocity, n, s);
+    }
+}
+
+template <typename V, bool L2, bool Decoupled>
+void adam_at(const float* g, float* w, float* m, float* v, const AdamStep& s, size_t i) {
+    using reg = typename V::reg;
+    reg weight = V::load(w + i);
+    reg grad = V::load(g + i);
+    if (L2) {
+        grad = V::add(grad, V::mul(V::set1(s.weight_decay), weight));
+    }
+    if (Decoupled) {
+        weight = V::mul(weight, V::set1(s.decay));
+    }
+    const reg beta1 = V::set1(s.beta1);
+    const reg beta2 = V::set1(s.beta2);
+    const reg one = V::set1(1.0f);
+    const reg m1 = V::add(V::mul(beta1, V::load(m + i)), V::mul(V::sub(one, beta1), grad));
+    const reg v1 = V::add(V::mul(beta2, V::load(v + i)), V::mul(V::sub(one, beta2), V::mul(grad, grad)));
+    V::store(m + i, m1);
+    V::store(v + i, v1);
+    // w -= step_size * m / (sqrt(v / correction2) + epsilon)
+    const reg denom = V::add(V::mul(V::sqrt(v1), V::set1(s.inv_sqrt_correction2)), V::set1(s.epsilon));
+    V::store(w + i, V::sub(weight, V::mul(V::set1(s.step_size), V::div(m1, denom))));
+}
+
+template <typename V, bool L2, bool Decoupled>
+void adam_loop(const float* g, float* w, float* m, float* v, size_t n, const AdamStep& s) {
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        adam_at<V, L2, Decoupled>(g, w, m, v, s, i);
+    }
+    for (; i < n; ++i) {
+        adam_at<VecScalar, L2, Decoupled>(g, w, m, v, s, i);
+    }
+}
+
+template <typename V>
+void adam(const float* g, float* w, float* m, float* v, size_t n, const AdamStep& s) {
+    const bool l2 = s.weight_decay != 0.0f;
+    const bool decoupled = s.decay != 1.0f;
+    if (l2) {
+        (decoupled ? &adam_loop<V, true, true> : &adam_loop<V, true, false>)(g, w, m, v, n, s);
+    } else {
+        (decoupled ? &adam_loop<V, false, true> : &adam_loop<V, false, false>)(g, w, m, v, n, s);
+    }
+}
+
+template <typename V>
+constexpr OptimizerKernels make_optimizer() {
+    return OptimizerKernels{
+        &sgd<V>,
+        &adam<V>,
+    };
+}
+
+} // namespace
+} // namespace kernels
+} // namespace nn
+
+#endif // NN_KERNELS_OPTIMIZER_IMPL_H
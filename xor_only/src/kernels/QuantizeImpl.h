@@ -0,0 +1,166 @@
+#ifndef NN_KERNELS_QUANTIZE_IMPL_H
+#define NN_KERNELS_QUANTIZE_IMPL_H
+
+// Integer kernels for quantized inference. Activations are limited to
+// 0..127, so a pair of byte products never exceeds 2 * 127 * 127 and the
+// saturating 16-bit sums of pmaddubsw stay exact. Every variant therefore
+// returns exactly the same int32 sums as the portable loop.
+
+#include "Kernels.h"
+#include <cmath>
+
+#if defined(NN_X86_KERNELS)
+#include <immintrin.h>
+#endif
+
+namespace nn {
+namespace kernels {
+namespace {
+
+// Not every variant uses every function, so they are inline to keep the
+// per-ISA units free of unused-function warnings.
+
+// Tile layout: a holds QUANT_TILE_ROWS weight rows interleaved per k-quad
+// (16 bytes per quad), b holds QUANT_TILE_COLS activation columns per
+// k-quad (64 bytes per quad), c receives the tile row-major.
+inline void quant_tile_loop(size_t quads, const int8_t* a, const uint8_t* b, int32_t* c) {
+    int32_t acc[QUANT_TILE_ROWS][QUANT_TILE_COLS] = {};
+    for (size_t q = 0; q < quads; ++q) {
+        for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+            const int8_t* w = a + r * 4;
+            for (size_t j = 0; j < QUANT_TILE_COLS; ++j) {
+                const uint8_t* x = b + j * 4;
+                acc[r][j] += w[0] * x[0] + w[1] * x[1] + w[2] * x[2] + w[3] * x[3];
+            }
+        }
+        a += QUANT_TILE_ROWS * 4;
+        b += QUANT_TILE_COLS * 4;
+    }
+    for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+        for (size_t j = 0; j < QUANT_TILE_COLS; ++j) {
+            c[r * QUANT_TILE_COLS + j] = acc[r][j];
+        }
+    }
+}
+
+// Clamping before rounding equals rounding before clamping, since the
+// bounds are integers; NaN becomes 0
+inline void quantize_loop(const float* in, uint8_t* out, size_t n, float inv_scale, float zero_point) {
+    for (size_t i = 0; i < n; ++i) {
+        float v = in[i] * inv_scale + zero_point;
+        v = v > 0.0f ? v : 0.0f;
+        v = v < 127.0f ? v : 127.0f;
+        out[i] = static_cast<uint8_t>(std::nearbyint(v));
+    }
+}
+
+#if defined(NN_X86_KERNELS) && defined(__SSE2__)
+inline void quantize_sse2(const float* in, uint8_t* out, size_t n, float inv_scale, float zero_point) {
+    const __m128 scale = _mm_set1_ps(inv_scale);
+    const __m128 zero = _mm_set1_ps(zero_point);
+    const __m128 low = _mm_setzero_ps();
+    const __m128 high = _mm_set1_ps(127.0f);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i q[4];
+        for (size_t k = 0; k < 4; ++k) {
+            __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4 * k), scale), zero);
+            // maxps returns its second operand when either is NaN
+            v = _mm_min_ps(_mm_max_ps(v, low), high);
+            q[k] = _mm_cvtps_epi32(v);
+        }
+        const __m128i words = _mm_packs_epi32(q[0], q[1]);
+        const __m128i words_hi = _mm_packs_epi32(q[2], q[3]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(words, words_hi));
+    }
+    quantize_loop(in + i, out + i, n - i, inv_scale, zero_point);
+}
+#endif
+
+#if defined(NN_X86_KERNELS) && defined(__AVX2__)
+inline void quant_tile_avx2(size_t quads, const int8_t* a, const uint8_t* b, int32_t* c) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc[QUANT_TILE_ROWS][2];
+    for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+        acc[r][0] = _mm256_setzero_si256();
+        acc[r][1] = _mm256_setzero_si256();
+    }
+    for (size_t q = 0; q < quads; ++q) {
+        const __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        const __m256i x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 32));
+        for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+            int32_t quad;
+            __builtin_memcpy(&quad, a + r * 4, 4);
+            const __m256i w = _mm256_set1_epi32(quad);
+            // u8 x s8 pairs to s16, then pairs of those to s32
+            acc[r][0] = _mm256_add_epi32(acc[r][0], _mm256_madd_epi16(_mm256_maddubs_epi16(x0, w), ones));
+            acc[r][1] = _mm256_add_epi32(acc[r][1], _mm256_madd_epi16(_mm256_maddubs_epi16(x1, w), ones));
+        }
+        a += QUANT_TILE_ROWS * 4;
+        b += QUANT_TILE_COLS * 4;
+    }
+    for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + r * QUANT_TILE_COLS), acc[r][0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(c + r * QUANT_TILE_COLS + 8), acc[r][1]);
+    }
+}
+#endif
+
+#if defined(NN_X86_KERNELS) && defined(__AVX512BW__)
+inline void quant_tile_avx512(size_t quads, const int8_t* a, const uint8_t* b, int32_t* c) {
+    const __m512i ones = _mm512_set1_epi16(1);
+    __m512i acc[QUANT_TILE_ROWS];
+    for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+        acc[r] = _mm512_setzero_si512();
+    }
+    for (size_t q = 0; q < quads; ++q) {
+        const __m512i x = _mm512_loadu_si512(b);
+        for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+            int32_t quad;
+            __builtin_memcpy(&quad, a + r * 4, 4);
+            const __m512i w = _mm512_set1_epi32(quad);
+            acc[r] = _mm512_add_epi32(acc[r], _mm512_madd_epi16(_mm512_maddubs_epi16(x, w), ones));
+        }
+        a += QUANT_TILE_ROWS * 4;
+        b += QUANT_TILE_COLS * 4;
+    }
+    for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+        _mm512_storeu_si512(c + r * QUANT_TILE_COLS, acc[r]);
+    }
+}
+
+// VNNI fuses the byte products and their sum into one instruction. It is
+// enabled for this function only and picked at runtime.
+__attribute__((target("avx512vnni")))
+inline void quant_tile_vnni(size_t quads, const int8_t* a, const uint8_t* b, int32_t* c) {
+    __m512i acc[QUANT_TILE_ROWS];
+    for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+        acc[r] = _mm512_setzero_si512();
+    }
+    for (size_t q = 0; q < quads; ++q) {
+        const __m512i x = _mm512_loadu_si512(b);
+        for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+            int32_t quad;
+            __builtin_memcpy(&quad, a + r * 4, 4);
+            acc[r] = _mm512_dpbusd_epi32(acc[r], x, _mm512_set1_epi32(quad));
+        }
+        a += QUANT_TILE_ROWS * 4;
+        b += QUANT_TILE_COLS * 4;
+    }
+    for (size_t r = 0; r < QUANT_TILE_ROWS; ++r) {
+        _mm512_storeu_si512(c + r * QUANT_TILE_COLS, acc[r]);
+    }
+}
+#endif
+
+constexpr QuantizedKernels make_quantized(
+    void (*tile)(size_t, const int8_t*, const uint8_t*, int32_t*),
+    void (*quantize)(const float*, uint8_t*, size_t, float, float)) {
+    return QuantizedKernels{tile, quantize};
+}
+
+} // namespace
+} // namespace kernels
+} // namespace nn
+
+#endif // NN_KERNELS_QUANTIZE_IMPL_H
@@ -0,0 +1,98 @@
+#ifndef NN_KERNELS_REDUCTION_IMPL_H
+#define NN_KERNELS_REDUCTION_IMPL_H
+
+// Reduction kernels written once against the Vec wrappers. Sums are
+// accumulated in a fixed number of lanes whatever the register width, so
+// every variant adds the same numbers in the same order and returns exactly
+// the scalar reference result.
+
+#include "Kernels.h"
+#include "Vec.h"
+#include <limits>
+
+namespace nn {
+namespace kernels {
+namespace {
+
+// Independent partial sums per block; a multiple of every register width
+constexpr size_t REDUCE_LANES = 16;
+
+// Blocks up to this size are summed lane-wise, larger ranges pairwise
+constexpr size_t REDUCE_BLOCK = 512;
+
+template <typename V>
+float block_sum(const float* x, size_t n) {
+    constexpr size_t regs = REDUCE_LANES / V::width;
+    typename V::reg acc[regs];
+    for (size_t r = 0; r < regs; ++r) {
+        acc[r] = V::zero();
+    }
+    size_t i = 0;
+    for (; i + REDUCE_LANES <= n; i += REDUCE_LANES) {
+        for (size_t r = 0; r < regs; ++r) {
+            acc[r] = V::add(acc[r], V::load(x + i + r * V::width));
+        }
+    }
+
+    // Fold the lanes as a balanced tree, then add the leftovers
+    float lanes[REDUCE_LANES];
+    for (size_t r = 0; r < regs; ++r) {
+        V::store(lanes + r * V::width, acc[r]);
+    }
+    for (size_t half = REDUCE_LANES / 2; half > 0; half /= 2) {
+        for (size_t l = 0; l < half; ++l) {
+            lanes[l] = lanes[l] + lanes[l + half];
+        }
+    }
+    float tail = 0.0f;
+    for (; i < n; ++i) {
+        tail = tail + x[i];
+    }
+    return lanes[0] + tail;
+}
+
+// Pairwise summation: the rounding error grows with log(n) instead of n
+template <typename V>
+float sum(const float* x, size_t n) {
+    if (n <= REDUCE_BLOCK) {
+        return block_sum<V>(x, n);
+    }
+    const size_t half = n / 2 / REDUCE_LANES * REDUCE_LANES;
+    return sum<V>(x, half) + sum<V>(x + half, n - half);
+}
+
+// Largest element, skipping NaNs; -inf for an empty or all-NaN range
+template <typename V>
+float max(const float* x, size_t n) {
+    constexpr float lowest = -std::numeric_limits<float>::infinity();
+    typename V::reg acc = V::set1(lowest);
+    size_t i = 0;
+    for (; i + V::width <= n; i += V::width) {
+        // max(a, b) returns b when either is NaN
+        acc = V::max(V::load(x + i), acc);
+    }
+    float lanes[V::width];
+    V::store(lanes, acc);
+    float result = lowest;
+    for (size_t l = 0; l < V::width; ++l) {
+        result = VecScalar::max(lanes[l], result);
+    }
+    for (; i < n; ++i) {
+        result = VecScalar::max(x[i], result);
+    }
+    return result;
+}
+
+template <typename V>
+constexpr ReductionKernels make_reductions() {
+    return ReductionKernels{
+        &sum<V>,
+        &max<V>,
+    };
+}
+
+} // namespace
+} // namespace kernels
+} // namespace nn
+
+#endif // NN_KERNELS_REDUCTION_IMPL_H
@@ -0,0 +1,81 @@
+#ifndef NN_KERNELS_SPARSE_IMPL_H
+#define NN_KERNELS_SPARSE_IMPL_H
+
+// Sparse-times-dense kernels written once against the Vec wrappers. Each
+// output is summed from zero in the order of the stored blocks with
+// separate multiplies and adds, so every variant matches the scalar
+// reference bit for bit, and both match the dense GEMM on the same weights.
+
+#include "Kernels.h"
+#include "Vec.h"
+
+namespace nn {
+namespace kernels {
+namespace {
+
+// out (Rows x n, row stride ldo) = sum over blocks p of
+// values[p * Rows + r] * (row cols[p] of x)
+template <typename V, size_t Rows>
+void sparse_rows(size_t blocks, const uint32_t* cols, const float* values,
+                 const float* x, size_t ldx, float* out, size_t ldo, size_t n) {
+    // Registers per output row; a single row gets more to hide latency
+    constexpr size_t regs = Rows == 1 ? 4 : 2;
+    constexpr size_t step = regs * V::width;
+    using reg = typename V::reg;
+
+    size_t j = 0;
+    for (; j + step <= n; j += step) {
+        reg acc[Rows][regs];
+        for (size_t r = 0; r < Rows; ++r) {
+            for (size_t k = 0; k < regs; ++k) {
+                acc[r][k] = V::zero();
+            }
+        }
+        for (size_t p = 0; p < blocks; ++p) {
+            const float* xr = x + cols[p] * ldx + j;
+            reg xv[regs];
+            for (size_t k = 0; k < regs; ++k) {
+                xv[k] = V::load(xr + k * V::width);
+            }
+            for (size_t r = 0; r < Rows; ++r) {
+                const reg w = V::set1(values[p * Rows + r]);
+                for (size_t k = 0; k < regs; ++k) {
+                    acc[r][k] = V::add(acc[r][k], V::mul(w, xv[k]));
+                }
+            }
+        }
+        for (size_t r = 0; r < Rows; ++r) {
+            for (size_t k = 0; k < regs; ++k) {
+                V::store(out + r * ldo + j + k * V::width, acc[r][k]);
+            }
+        }
+    }
+
+    // Leftover columns, one at a time in the same order
+    for (; j < n; ++j) {
+        float acc[Rows] = {};
+        for (size_t p = 0; p < blocks; ++p) {
+            const float xv = x[cols[p] * ldx + j];
+            for (size_t r = 0; r < Rows; ++r) {
+                acc[r] = acc[r] + values[p * Rows + r] * xv;
+            }
+        }
+        for (size_t r = 0; r < Rows; ++r) {
+            out[r * ldo + j] = acc[r];
+        }
+    }
+}
+
+template <typename V>
+constexpr SparseKernels make_sparse() {
+    return SparseKernels{
+        &sparse_rows<V, 1>,
+        &sparse_rows<V, SPARSE_BLOCK_ROWS>,
+    };
+}
+
+} // namespace
+} // namespace kernels
+} // namespace nn
+
+#endif // NN_KERNELS_SPARSE_IMPL_H
@@ -0,0 +1,67 @@
+#ifndef NN_KERNELS_TABLES_H
+#define NN_KERNELS_TABLES_H
+
+// Kernel tables exported by the per-ISA translation units. The SIMD tables
+// only exist when the build compiles those units with their ISA flags
+// (NN_X86_KERNELS).
+
+#include "Kernels.h"
+
+namespace nn {
+namespace kernels {
+
+namespace scalar {
+extern const ElementwiseKernels elementwise_table;
+extern const ReductionKernels reduction_table;
+extern const ConversionKernels conversion_table;
+extern const QuantizedKernels quantized_table;
+extern const SparseKernels sparse_table;
+extern const GemmKernels gemm_table;
+extern const OptimizerKernels optimizer_table;
+extern const MathKernels math_accurate_table;
+extern const MathKernels math_fast_table;
+}
+
+#if defined(NN_X86_KERNELS)
+namespace sse2 {
+extern const ElementwiseKernels elementwise_table;
+extern const ReductionKernels reduction_table;
+extern const ConversionKernels conversion_table;
+extern const QuantizedKernels quantized_table;
+extern const SparseKernels sparse_table;
+extern const GemmKernels gemm_table;
+extern const OptimizerKernels optimizer_table;
+extern const MathKernels math_accurate_table;
+extern const MathKernels math_fast_table;
+}
+
+namespace avx2 {
+extern const ElementwiseKernels elementwise_table;
+extern const ReductionKernels reduction_table;
+extern const ConversionKernels conversion_table;
+extern const QuantizedKernels quantized_table;
+extern const SparseKernels sparse_table;
+extern const GemmKernels gemm_table;
+extern const OptimizerKernels optimizer_table;
+extern const MathKernels math_accurate_table;
+extern const MathKernels math_fast_table;
+}
+
+namespace avx512 {
+extern const ElementwiseKernels elementwise_table;
+extern const ReductionKernels reduction_table;
+extern const ConversionKernels conversion_table;
+extern const QuantizedKernels quantized_table;
+extern const SparseKernels sparse_table;
+extern const GemmKernels gemm_table;
+extern const OptimizerKernels optimizer_table;
+extern const QuantizedKernels quantized_vnni_table;
+extern const MathKernels math_accurate_table;
+extern const MathKernels math_fast_table;
+}
+#endif
+
+} // namespace kernels
+} // namespace nn
+
+#endif // NN_KERNELS_TABLES_H
@@ -0,0 +1,199 @@
+#ifndef NN_KERNELS_VEC_H
+#define NN_KERNELS_VEC_H
+
+// Thin wrappers over one SIMD register type per instruction set. Each kernel
+// translation unit is compiled with its own -m flags and only sees the
+// wrappers its flags enable. Everything lives in an anonymous namespace so
+// that inline functions built for different ISAs never get merged by the
+// linker.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace nn {
+namespace kernels {
+namespace {
+
+struct VecScalar {
+    using reg = float;
+    static constexpr size_t width = 1;
+
+    static reg load(const float* p) { return *p; }
+    static void store(float* p, reg v) { *p = v; }
+    static reg set1(float v) { return v; }
+    static reg zero() { return 0.0f; }
+    static reg add(reg a, reg b) { return a + b; }
+    static reg sub(reg a, reg b) { return a - b; }
+    static reg mul(reg a, reg b) { return a * b; }
+    static reg max(reg a, reg b) { return std::max(b, a); }
+
+    // Extended operations used by the math kernels
+    using ireg = int32_t;
+    using mask = bool;
+
+    static reg div(reg a, reg b) { return a / b; }
+    static reg min(reg a, reg b) { return std::min(b, a); }
+    static reg fmadd(reg a, reg b, reg c) { return a * b + c; }
+    static reg rcp(reg a) { return 1.0f / a; }
+    static reg sqrt(reg a) { return std::sqrt(a); }
+    static mask lt(reg a, reg b) { return a < b; }
+    static mask le(reg a, reg b) { return a <= b; }
+    static mask eq(reg a, reg b) { return a == b; }
+    static mask is_nan(reg a) { return a != a; }
+    static reg select(mask m, reg a, reg b) { return m ? a : b; }
+    static reg bit_and(reg a, reg b) { return as_float(as_int(a) & as_int(b)); }
+    static reg bit_or(reg a, reg b) { return as_float(as_int(a) | as_int(b)); }
+    static reg bit_xor(reg a, reg b) { return as_float(as_int(a) ^ as_int(b)); }
+
+    static ireg iset1(int32_t v) { return v; }
+    static ireg round_int(reg a) { return static_cast<int32_t>(std::nearbyint(a)); }
+    static reg to_float(ireg a) { return static_cast<float>(a); }
+    static ireg iadd(ireg a, ireg b) { return a + b; }
+    static ireg isub(ireg a, ireg b) { return a - b; }
+    template <int Bits> static ireg shl(ireg a) { return static_cast<int32_t>(static_cast<uint32_t>(a) << Bits); }
+    template <int Bits> static ireg sra(ireg a) { return a >> Bits; }
+    static reg as_float(ireg a) { float f; std::memcpy(&f, &a, sizeof(f)); return f; }
+    static ireg as_int(reg a) { int32_t i; std::memcpy(&i, &a, sizeof(i)); return i; }
+};
+
+#if defined(__SSE2__)
+struct VecSSE2 {
+    using reg = __m128;
+    static constexpr size_t width = 4;
+
+    static reg load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, reg v) { _mm_storeu_ps(p, v); }
+    static reg set1(float v) { return _mm_set1_ps(v); }
+    static reg zero() { return _mm_setzero_ps(); }
+    static reg add(reg a, reg b) { return _mm_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm_sub_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm_mul_ps(a, b); }
+    static reg max(reg a, reg b) { return _mm_max_ps(a, b); }
+
+    using ireg = __m128i;
+    using mask = __m128;
+
+    static reg div(reg a, reg b) { return _mm_div_ps(a, b); }
+    static reg min(reg a, reg b) { return _mm_min_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    static reg rcp(reg a) { return _mm_rcp_ps(a); }
+    static reg sqrt(reg a) { return _mm_sqrt_ps(a); }
+    static mask lt(reg a, reg b) { return _mm_cmplt_ps(a, b); }
+    static mask le(reg a, reg b) { return _mm_cmple_ps(a, b); }
+    static mask eq(reg a, reg b) { return _mm_cmpeq_ps(a, b); }
+    static mask is_nan(reg a) { return _mm_cmpunord_ps(a, a); }
+    static reg select(mask m, reg a, reg b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static reg bit_and(reg a, reg b) { return _mm_and_ps(a, b); }
+    static reg bit_or(reg a, reg b) { return _mm_or_ps(a, b); }
+    static reg bit_xor(reg a, reg b) { return _mm_xor_ps(a, b); }
+
+    static ireg iset1(int32_t v) { return _mm_set1_epi32(v); }
+    static ireg round_int(reg a) { return _mm_cvtps_epi32(a); }
+    static reg to_float(ireg a) { return _mm_cvtepi32_ps(a); }
+    static ireg iadd(ireg a, ireg b) { return _mm_add_epi32(a, b); }
+    static ireg isub(ireg a, ireg b) { return _mm_sub_epi32(a, b); }
+    template <int Bits> static ireg shl(ireg a) { return _mm_slli_epi32(a, Bits); }
+    template <int Bits> static ireg sra(ireg a) { return _mm_srai_epi32(a, Bits); }
+    static reg as_float(ireg a) { return _mm_castsi128_ps(a); }
+    static ireg as_int(reg a) { return _mm_castps_si128(a); }
+};
+#endif
+
+#if defined(__AVX2__)
+struct VecAVX2 {
+    using reg = __m256;
+    static constexpr size_t width = 8;
+
+    static reg load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, reg v) { _mm256_storeu_ps(p, v); }
+    static reg set1(float v) { return _mm256_set1_ps(v); }
+    static reg zero() { return _mm256_setzero_ps(); }
+    static reg add(reg a, reg b) { return _mm256_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm256_sub_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm256_mul_ps(a, b); }
+    static reg max(reg a, reg b) { return _mm256_max_ps(a, b); }
+
+    using ireg = __m256i;
+    using mask = __m256;
+
+    static reg div(reg a, reg b) { return _mm256_div_ps(a, b); }
+    static reg min(reg a, reg b) { return _mm256_min_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+    static reg rcp(reg a) { return _mm256_rcp_ps(a); }
+    static reg sqrt(reg a) { return _mm256_sqrt_ps(a); }
+    static mask lt(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static mask le(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static mask eq(reg a, reg b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    static mask is_nan(reg a) { return _mm256_cmp_ps(a, a, _CMP_UNORD_Q); }
+    static reg select(mask m, reg a, reg b) { return _mm256_blendv_ps(b, a, m); }
+    static reg bit_and(reg a, reg b) { return _mm256_and_ps(a, b); }
+    static reg bit_or(reg a, reg b) { return _mm256_or_ps(a, b); }
+    static reg bit_xor(reg a, reg b) { return _mm256_xor_ps(a, b); }
+
+    static ireg iset1(int32_t v) { return _mm256_set1_epi32(v); }
+    static ireg round_int(reg a) { return _mm256_cvtps_epi32(a); }
+    static reg to_float(ireg a) { return _mm256_cvtepi32_ps(a); }
+    static ireg iadd(ireg a, ireg b) { return _mm256_add_epi32(a, b); }
+    static ireg isub(ireg a, ireg b) { return _mm256_sub_epi32(a, b); }
+    template <int Bits> static ireg shl(ireg a) { return _mm256_slli_epi32(a, Bits); }
+    template <int Bits> static ireg sra(ireg a) { return _mm256_srai_epi32(a, Bits); }
+    static reg as_float(ireg a) { return _mm256_castsi256_ps(a); }
+    static ireg as_int(reg a) { return _mm256_castps_si256(a); }
+};
+#endif
+
+#if defined(__AVX512F__)
+struct VecAVX512 {
+    using reg = __m512;
+    static constexpr size_t width = 16;
+
+    static reg load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, reg v) { _mm512_storeu_ps(p, v); }
+    static reg set1(float v) { return _mm512_set1_ps(v); }
+    static reg zero() { return _mm512_setzero_ps(); }
+    static reg add(reg a, reg b) { return _mm512_add_ps(a, b); }
+    static reg sub(reg a, reg b) { return _mm512_sub_ps(a, b); }
+    static reg mul(reg a, reg b) { return _mm512_mul_ps(a, b); }
+    static reg max(reg a, reg b) { return _mm512_max_ps(a, b); }
+
+    using ireg = __m512i;
+    using mask = __mmask16;
+
+    static reg div(reg a, reg b) { return _mm512_div_ps(a, b); }
+    static reg min(reg a, reg b) { return _mm512_min_ps(a, b); }
+    static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+    static reg rcp(reg a) { return _mm512_rcp14_ps(a); }
+    static reg sqrt(reg a) { return _mm512_sqrt_ps(a); }
+    static mask lt(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static mask le(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+    static mask eq(reg a, reg b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+    static mask is_nan(reg a) { return _mm512_cmp_ps_mask(a, a, _CMP_UNORD_Q); }
+    static reg select(mask m, reg a, reg b) { return _mm512_mask_blend_ps(m, b, a); }
+    static reg bit_and(reg a, reg b) { return as_float(_mm512_and_si512(as_int(a), as_int(b))); }
+    static reg bit_or(reg a, reg b) { return as_float(_mm512_or_si512(as_int(a), as_int(b))); }
+    static reg bit_xor(reg a, reg b) { return as_float(_mm512_xor_si512(as_int(a), as_int(b))); }
+
+    static ireg iset1(int32_t v) { return _mm512_set1_epi32(v); }
+    static ireg round_int(reg a) { return _mm512_cvtps_epi32(a); }
+    static reg to_float(ireg a) { return _mm512_cvtepi32_ps(a); }
+    static ireg iadd(ireg a, ireg b) { return _mm512_add_epi32(a, b); }
+    static ireg isub(ireg a, ireg b) { return _mm512_sub_epi32(a, b); }
+    template <int Bits> static ireg shl(ireg a) { return _mm512_slli_epi32(a, Bits); }
+    template <int Bits> static ireg sra(ireg a) { return _mm512_srai_epi32(a, Bits); }
+    static reg as_float(ireg a) { return _mm512_castsi512_ps(a); }
+    static ireg as_int(reg a) { return _mm512_castps_si512(a); }
+};
+#endif
+
+} // namespace
+} // namespace kernels
+} // namespace nn
+
+#endif // NN_KERNELS_VEC_H
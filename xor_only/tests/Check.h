@@ -0,0 +1,136 @@
+#ifndef NN_TESTS_CHECK_H
+#define NN_TESTS_CHECK_H
+
+// Minimal assertions for the test executables: failures are counted and
+// printed, and main returns check_result() so ctest sees them. Also holds
+// the inputs and comparisons the per-feature tests share.
+
+#include "Kernels.h"
+#include "Network.h"
+#include "Scheduler.h"
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace check {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void fail(const char* file, int line, const char* what) {
+    std::printf("%s:%d: check failed: %s\n", file, line, what);
+    ++failures();
+}
+
+inline int result(const char* name) {
+    std::printf("%s: %s (%d failures)\n", name, failures() == 0 ? "passed" : "FAILED", failures());
+    return failures() == 0 ? 0 : 1;
+}
+
+// Byte-wise equality, so NaNs and signed zeros must match too
+template <typename T>
+bool same_bits(const T* a, const T* b, size_t n) {
+    return std::memcmp(a, b, n * sizeof(T)) == 0;
+}
+
+// Odd length and offset so every kernel variant runs its tail and
+// unaligned paths
+constexpr size_t N = 1037;
+constexpr size_t OFFSET = 3;
+
+inline std::mt19937& generator() {
+    static std::mt19937 gen(1234);
+    return gen;
+}
+
+// n + OFFSET values uniform in [low, high); kernels read from OFFSET
+inline std::vector<float> random_floats(size_t n, float low, float high) {
+    std::uniform_real_distribution<float> dis(low, high);
+    std::vector<float> v(n + OFFSET);
+    for (auto& x : v) {
+        x = dis(generator());
+    }
+    return v;
+}
+
+// Sprinkles NaN, infinities, zeros of both signs and subnormals over v
+inline void add_special_values(std::vector<float>& v) {
+    const float specials[] = {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(),
+                              -std::numeric_limits<float>::infinity(), 0.0f, -0.0f, 1e-40f, -1e-40f};
+    for (size_t i = 0; i < sizeof(specials) / sizeof(specials[0]); ++i) {
+        v[OFFSET + i * 97] = specials[i];
+    }
+}
+
+// Calls f for each instruction set this CPU supports
+template <typename F>
+void for_each_isa(F&& f) {
+    using nn::kernels::Isa;
+    for (Isa isa : {Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::AVX512}) {
+        if (!nn::kernels::isa_supported(isa)) {
+            std::printf("%s: not supported, skipped\n", nn::kernels::isa_name(isa));
+            continue;
+        }
+        std::printf("%s\n", nn::kernels::isa_name(isa));
+        f(isa);
+    }
+}
+
+// Runs op with one thread and with four and checks that the tensors it
+// returns are the same bits
+inline void threads_agree(const char* name, const std::function<std::vector<nn::Tensor>()>& op) {
+    nn::set_num_threads(1);
+    const std::vector<nn::Tensor> serial = op();
+    nn::set_num_threads(4);
+    const std::vector<nn::Tensor> parallel = op();
+    nn::set_num_threads(0);
+
+    bool same = serial.size() == parallel.size();
+    for (size_t i = 0; same && i < serial.size(); ++i) {
+        const nn::Tensor a = serial[i].to(nn::DType::Float32).contiguous();
+        const nn::Tensor b = parallel[i].to(nn::DType::Float32).contiguous();
+        same = a.shape() == b.shape() && same_bits(a.data(), b.data(), a.size());
+    }
+    if (!same) {
+        std::printf("%s: differs between 1 and 4 threads\n", name);
+        ++failures();
+    }
+}
+
+// Float32 copies of every parameter of net
+inline std::vector<nn::Tensor> parameters(nn::Network& net) {
+    std::vector<nn::Tensor> result;
+    for (auto* layer : net.get_layers()) {
+        for (auto* parameter : layer->get_parameters()) {
+            result.push_back(parameter->to(nn::DType::Float32).contiguous());
+        }
+    }
+    return result;
+}
+
+} // namespace check
+
+#define CHECK(condition)                                          \
+    do {                                                          \
+        if (!(condition)) {                                       \
+            check::fail(__FILE__, __LINE__, #condition);          \
+        }                                                         \
+    } while (0)
+
+// Checks that statement does not throw
+#define CHECK_NO_THROW(statement)                                 \
+    do {                                                          \
+        try {                                                     \
+            statement;                                            \
+        } catch (const std::exception& e) {                       \
+            check::fail(__FILE__, __LINE__, e.what());            \
+        }                                                         \
+    } while (0)
+
+#endif // NN_TESTS_CHECK_H
@@ -0,0 +1,66 @@
+#include "BenchUtil.h"
+#include "Check.h"
+#include <vector>
+
+// Checks that bias and activation applied in the GEMM epilogue give the
+// same bits as separate passes, through linear_into and through training a
+// fused network, and that the fused product does with one thread and with
+// several.
+
+using namespace nn;
+
+namespace {
+
+void check_linear(const Tensor& weights, const Tensor& input, const Tensor& bias) {
+    for (Activation activation : {Activation::Identity, Activation::Sigmoid, Activation::ReLU}) {
+        Tensor fused;
+        linear_into(fused, weights, input, bias, activation);
+        Tensor expected;
+        matmul_into(expected, weights, input);
+        expected.add_(bias);
+        if (activation == Activation::Sigmoid) {
+            expected = expected.sigmoid();
+        } else if (activation == Activation::ReLU) {
+            expected = expected.relu();
+        }
+        CHECK(fused.shape() == expected.shape() && check::same_bits(fused.data(), expected.data(), fused.size()));
+    }
+}
+
+// A step of training on a network whose sigmoids are fused into Linear
+// leaves the same parameters as on one with separate sigmoid layers
+void check_training(const Tensor& inputs, const Tensor& targets) {
+    Network fused, separate;
+    std::mt19937 fused_gen(3), separate_gen(3);
+    bench::build(fused, {64, 48, 16}, fused_gen, true);
+    bench::build(separate, {64, 48, 16}, separate_gen, false);
+    MSELoss loss;
+    fused.train_step(inputs, targets, loss, 0.1f);
+    separate.train_step(inputs, targets, loss, 0.1f);
+    const std::vector<Tensor> a = check::parameters(fused);
+    const std::vector<Tensor> b = check::parameters(separate);
+    CHECK(a.size() == b.size());
+    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+        CHECK(check::same_bits(a[i].data(), b[i].data(), a[i].size()));
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 gen(99);
+    const Tensor weights = bench::random_tensor(300, 500, gen);
+    const Tensor input = bench::random_tensor(500, 200, gen);
+    const Tensor bias = bench::random_tensor(300, 1, gen);
+
+    check_linear(weights, input, bias);
+    check_linear(weights, input.slice(1, 0, 100), bias);
+    check_training(bench::random_tensor(64, 32, gen), bench::random_tensor(16, 32, gen, 0.5f));
+
+    check::threads_agree("linear with epilogue", [&] {
+        Tensor out;
+        linear_into(out, weights, input.slice(1, 0, 100), bias, Activation::Sigmoid);
+        return std::vector<Tensor>{out};
+    });
+    return check::result("epilogue_test");
+}
@@ -0,0 +1,112 @@
+#include "Check.h"
+#include <vector>
+
+// Compares the element-wise kernels of each instruction set this CPU
+// supports with the scalar reference table, and checks each GEMM tile
+// against a naive sum. Both must return the same bits. The other tables are
+// checked by the test of their feature; the transcendental kernels, which
+// need not match exactly, in math_test.cpp.
+
+using namespace nn;
+using namespace nn::kernels;
+
+namespace {
+
+using check::add_special_values;
+using check::N;
+using check::OFFSET;
+using check::random_floats;
+
+void check_elementwise(const ElementwiseKernels& k, const ElementwiseKernels& ref) {
+    std::vector<float> a = random_floats(N, -4.0f, 4.0f);
+    std::vector<float> b = random_floats(N, -4.0f, 4.0f);
+    std::vector<float> y = random_floats(N, 0.0f, 1.0f);
+    add_special_values(a);
+    const float* pa = a.data() + OFFSET;
+    const float* pb = b.data() + OFFSET;
+    const float* py = y.data() + OFFSET;
+    std::vector<float> out(N), expected(N);
+
+    void (*binary[][2])(const float*, const float*, float*, size_t) = {
+        {k.add, ref.add}, {k.sub, ref.sub}, {k.mul, ref.mul}, {k.max, ref.max}};
+    for (auto& f : binary) {
+        f[0](pa, pb, out.data(), N);
+        f[1](pa, pb, expected.data(), N);
+        CHECK(check::same_bits(out.data(), expected.data(), N));
+        // And with the special values in the second operand
+        f[0](pb, pa, out.data(), N);
+        f[1](pb, pa, expected.data(), N);
+        CHECK(check::same_bits(out.data(), expected.data(), N));
+    }
+    void (*backward[][2])(const float*, const float*, float*, size_t) = {
+        {k.sigmoid_backward, ref.sigmoid_backward}, {k.relu_backward, ref.relu_backward}};
+    for (auto& f : backward) {
+        f[0](py, pa, out.data(), N);
+        f[1](py, pa, expected.data(), N);
+        CHECK(check::same_bits(out.data(), expected.data(), N));
+        f[0](pa, pb, out.data(), N);
+        f[1](pa, pb, expected.data(), N);
+        CHECK(check::same_bits(out.data(), expected.data(), N));
+    }
+    void (*scalar[][2])(const float*, float, float*, size_t) = {
+        {k.add_scalar, ref.add_scalar}, {k.mul_scalar, ref.mul_scalar}};
+    for (auto& f : scalar) {
+        f[0](pa, 1.75f, out.data(), N);
+        f[1](pa, 1.75f, expected.data(), N);
+        CHECK(check::same_bits(out.data(), expected.data(), N));
+    }
+
+    k.fill(out.data(), -2.5f, N);
+    ref.fill(expected.data(), -2.5f, N);
+    CHECK(check::same_bits(out.data(), expected.data(), N));
+
+    k.relu(pa, out.data(), N);
+    ref.relu(pa, expected.data(), N);
+    CHECK(check::same_bits(out.data(), expected.data(), N));
+
+    std::vector<float> y1(pb, pb + N), y2(pb, pb + N);
+    k.axpy(-0.3f, pa, y1.data(), N);
+    ref.axpy(-0.3f, pa, y2.data(), N);
+    CHECK(check::same_bits(y1.data(), y2.data(), N));
+}
+
+// Tiles differ in shape between instruction sets, so each GEMM tile is
+// checked against a naive k-ordered sum, on full and edge tiles
+void check_gemm_tile(const GemmTile& tile) {
+    const size_t kc = 37, ldc = 41;
+    const std::vector<float> a = random_floats(tile.mr * kc, -1.0f, 1.0f);
+    const std::vector<float> b = random_floats(tile.nr * kc, -1.0f, 1.0f);
+    const std::vector<float> bias = random_floats(tile.mr, -1.0f, 1.0f);
+    const std::vector<float> initial = random_floats(tile.mr * ldc, -1.0f, 1.0f);
+
+    const size_t shapes[][2] = {{tile.mr, tile.nr}, {tile.mr, 1}, {1, tile.nr}, {(tile.mr + 1) / 2, (tile.nr + 1) / 2}};
+    for (const auto& shape : shapes) {
+        for (bool accumulate : {false, true}) {
+            for (const float* shift : {static_cast<const float*>(nullptr), bias.data()}) {
+                std::vector<float> c = initial, expected = initial;
+                tile.kernel(kc, a.data(), b.data(), c.data(), ldc, shape[0], shape[1], accumulate, shift);
+                for (size_t i = 0; i < shape[0]; ++i) {
+                    for (size_t j = 0; j < shape[1]; ++j) {
+                        float acc = accumulate ? initial[i * ldc + j] : 0.0f;
+                        for (size_t p = 0; p < kc; ++p) {
+                            acc += a[p * tile.mr + i] * b[p * tile.nr + j];
+                        }
+                        expected[i * ldc + j] = shift ? acc + shift[i] : acc;
+                    }
+                }
+                CHECK(check::same_bits(c.data(), expected.data(), c.size()));
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    check::for_each_isa([](Isa isa) {
+        check_elementwise(elementwise(isa), elementwise(Isa::Scalar));
+        check_gemm_tile(kernels::gemm(isa).wide);
+        check_gemm_tile(kernels::gemm(isa).narrow);
+    });
+    return check::result("kernel_test");
+}
@@ -0,0 +1,52 @@
+#include "Allocator.h"
+#include "Check.h"
+#include "FixedLayer.h"
+#include "Network.h"
+
+// Regression checks for layers on the inference path
+
+using namespace nn;
+
+namespace {
+
+// FixedLinear matches Linear bit for bit through predict, and a Network of
+// them predicts without allocating once its buffers exist
+void check_fixed_predict() {
+    Network fixed;
+    auto* first = new FixedLinear<2, 4>();
+    auto* second = new FixedLinear<4, 1>();
+    fixed.add_layer(first);
+    fixed.add_layer(new Sigmoid());
+    fixed.add_layer(second);
+    fixed.add_layer(new Sigmoid());
+
+    Network dynamic;
+    auto* first_linear = new Linear(2, 4);
+    auto* second_linear = new Linear(4, 1);
+    first_linear->set_weights(*first->get_parameters()[0]);
+    first_linear->set_bias(*first->get_parameters()[1]);
+    second_linear->set_weights(*second->get_parameters()[0]);
+    second_linear->set_bias(*second->get_parameters()[1]);
+    dynamic.add_layer(first_linear);
+    dynamic.add_layer(new Sigmoid());
+    dynamic.add_layer(second_linear);
+    dynamic.add_layer(new Sigmoid());
+
+    const Tensor input(std::vector<std::vector<float>>{{0.0f, 0.0f, 1.0f, 1.0f}, {0.0f, 1.0f, 0.0f, 1.0f}});
+    const Tensor expected = dynamic.predict(input);
+    const Tensor& output = fixed.predict(input);
+    CHECK(output.shape() == expected.shape() && check::same_bits(output.data(), expected.data(), output.size()));
+
+    const size_t before = default_allocator()->stats().allocations;
+    for (int i = 0; i < 100; ++i) {
+        fixed.predict(input);
+    }
+    CHECK(default_allocator()->stats().allocations == before);
+}
+
+} // namespace
+
+int main() {
+    check_fixed_predict();
+    return check::result("layer_test");
+}
@@ -0,0 +1,91 @@
+#include "BenchUtil.h"
+#include "Check.h"
+#include "FastMath.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// Compares the transcendental kernels of each supported instruction set
+// with the scalar table. Unlike the other kernels they need not return the
+// same bits:
+// - Accurate: AVX2 and AVX-512 evaluate the polynomials with fused
+//   multiply-adds, so they may differ from scalar and SSE2 in the last bits
+// - Fast: every SIMD variant uses the approximate reciprocal instruction
+//   where scalar divides, and NaN inputs give unspecified results
+// Those are checked against the scalar results within twice the documented
+// error bound of each tier (FastMath.h); Accurate special values must match.
+
+using namespace nn;
+using namespace nn::kernels;
+
+namespace {
+
+using check::add_special_values;
+using check::N;
+using check::OFFSET;
+using check::random_floats;
+
+// Relative difference, treating matching special values as equal
+bool close(float a, float b, float tolerance) {
+    if (std::isnan(a) || std::isnan(b)) {
+        return std::isnan(a) && std::isnan(b);
+    }
+    if (std::isinf(a) || std::isinf(b) || a == 0.0f || b == 0.0f) {
+        return a == b || std::fabs(a - b) <= std::numeric_limits<float>::min();
+    }
+    return std::fabs(a - b) <= tolerance * std::fabs(b);
+}
+
+void check_math(const MathKernels& k, const MathKernels& ref, MathPrecision precision, bool exact) {
+    struct Case {
+        void (*fn)(const float*, float*, size_t);
+        void (*ref)(const float*, float*, size_t);
+        float low, high;
+        float accurate, fast;  // Documented error bounds
+    };
+    const Case cases[] = {
+        {k.exp, ref.exp, -87.0f, 88.0f, 1.2e-7f, 6.0e-5f},
+        {k.log, ref.log, 1e-30f, 1e30f, 8.0e-8f, 3.9e-6f},
+        {k.sigmoid, ref.sigmoid, -80.0f, 80.0f, 1.8e-7f, 5.9e-5f},
+        {k.tanh, ref.tanh, -20.0f, 20.0f, 1.4e-7f, 2.1e-5f},
+    };
+    for (const Case& c : cases) {
+        std::vector<float> in = random_floats(N, c.low, c.high);
+        if (precision == MathPrecision::Accurate) {
+            add_special_values(in);
+        }
+        std::vector<float> out(N), expected(N);
+        c.fn(in.data() + OFFSET, out.data(), N);
+        c.ref(in.data() + OFFSET, expected.data(), N);
+        if (exact) {
+            CHECK(check::same_bits(out.data(), expected.data(), N));
+            continue;
+        }
+        const float tolerance = 2.0f * (precision == MathPrecision::Accurate ? c.accurate : c.fast);
+        size_t bad = 0;
+        for (size_t i = 0; i < N; ++i) {
+            bad += !close(out[i], expected[i], tolerance);
+        }
+        CHECK(bad == 0);
+    }
+}
+
+} // namespace
+
+int main() {
+    check::for_each_isa([](Isa isa) {
+        for (MathPrecision precision : {MathPrecision::Accurate, MathPrecision::Fast}) {
+            // See the list at the top of the file
+            const bool exact = isa == Isa::Scalar || (isa == Isa::SSE2 && precision == MathPrecision::Accurate);
+            check_math(kernels::math(isa, precision), kernels::math(Isa::Scalar, precision), precision, exact);
+        }
+    });
+
+    std::mt19937 gen(99);
+    const Tensor a = bench::random_tensor(300, 500, gen);
+    check::threads_agree("transcendental", [&] {
+        const Tensor squares = a * a;
+        return std::vector<Tensor>{a.sigmoid(), a.tanh(), a.exp(MathPrecision::Fast), squares.log()};
+    });
+    return check::result("math_test");
+}
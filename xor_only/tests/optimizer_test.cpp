@@ -0,0 +1,101 @@
+#include "BenchUtil.h"
+#include "Check.h"
+#include "Trainer.h"
+#include <memory>
+#include <vector>
+
+// Checks that the fused SGD and Adam kernels of each supported instruction
+// set return the same bits as the scalar table, that the optimizers reduce
+// to the plain updates they generalize, and that training with them leaves
+// the same parameters with one thread and with several.
+
+using namespace nn;
+using namespace nn::kernels;
+
+namespace {
+
+using check::N;
+using check::OFFSET;
+using check::random_floats;
+
+void check_optimizer(const OptimizerKernels& k, const OptimizerKernels& ref) {
+    const std::vector<float> g = random_floats(N, -1.0f, 1.0f);
+    const std::vector<float> w = random_floats(N, -1.0f, 1.0f);
+    const std::vector<float> m = random_floats(N, -0.1f, 0.1f);
+    const std::vector<float> v = random_floats(N, 0.0f, 0.01f);
+
+    const SgdStep sgd_steps[] = {{0.1f, 0.0f, 0.0f, false}, {0.1f, 0.9f, 0.0f, false},
+                                 {0.1f, 0.9f, 1e-3f, true}, {0.1f, 0.0f, 1e-3f, false}};
+    for (const SgdStep& step : sgd_steps) {
+        std::vector<float> w1 = w, w2 = w, v1 = m, v2 = m;
+        k.sgd(g.data() + OFFSET, w1.data() + OFFSET, v1.data() + OFFSET, N, step);
+        ref.sgd(g.data() + OFFSET, w2.data() + OFFSET, v2.data() + OFFSET, N, step);
+        CHECK(check::same_bits(w1.data(), w2.data(), w1.size()));
+        CHECK(check::same_bits(v1.data(), v2.data(), v1.size()));
+    }
+
+    const AdamStep adam_steps[] = {{0.01f, 0.9f, 0.999f, 1e-8f, 1.2f, 0.0f, 1.0f},
+                                   {0.01f, 0.9f, 0.999f, 1e-8f, 1.2f, 1e-3f, 1.0f},
+                                   {0.01f, 0.9f, 0.999f, 1e-8f, 1.2f, 0.0f, 0.9999f}};
+    for (const AdamStep& step : adam_steps) {
+        std::vector<float> w1 = w, w2 = w, m1 = m, m2 = m, v1 = v, v2 = v;
+        k.adam(g.data() + OFFSET, w1.data() + OFFSET, m1.data() + OFFSET, v1.data() + OFFSET, N, step);
+        ref.adam(g.data() + OFFSET, w2.data() + OFFSET, m2.data() + OFFSET, v2.data() + OFFSET, N, step);
+        CHECK(check::same_bits(w1.data(), w2.data(), w1.size()));
+        CHECK(check::same_bits(m1.data(), m2.data(), m1.size()));
+        CHECK(check::same_bits(v1.data(), v2.data(), v1.size()));
+    }
+}
+
+// Parameters after a few shuffled epochs with the optimizer make returns
+// (null for the layers' own updates)
+std::vector<Tensor> train(const std::vector<size_t>& sizes, const Tensor& inputs, const Tensor& targets,
+                          std::unique_ptr<Optimizer> (*make)()) {
+    Network net;
+    std::mt19937 gen(3);
+    bench::build(net, sizes, gen, true);
+    net.set_optimizer(make());
+    Trainer trainer(net, 128);
+    trainer.set_shuffle(true, 5);
+    MSELoss loss;
+    for (int epoch = 0; epoch < 3; ++epoch) {
+        trainer.train_epoch(inputs, targets, loss, 0.05f);
+    }
+    return check::parameters(net);
+}
+
+bool same_parameters(const std::vector<Tensor>& a, const std::vector<Tensor>& b) {
+    bool same = a.size() == b.size();
+    for (size_t i = 0; same && i < a.size(); ++i) {
+        same = check::same_bits(a[i].data(), b[i].data(), a[i].size());
+    }
+    return same;
+}
+
+} // namespace
+
+int main() {
+    check::for_each_isa([](Isa isa) { check_optimizer(optimizer(isa), optimizer(Isa::Scalar)); });
+
+    std::mt19937 gen(99);
+    const Tensor inputs = bench::random_tensor(64, 512, gen);
+    const Tensor targets = bench::random_tensor(16, 512, gen, 0.5f);
+
+    // SGD without momentum or decay is Linear::update_parameters, and AdamW
+    // without decay is Adam
+    const std::vector<size_t> small = {64, 32, 16};
+    CHECK(same_parameters(train(small, inputs, targets, [] { return std::unique_ptr<Optimizer>(new SGD()); }),
+                          train(small, inputs, targets, [] { return std::unique_ptr<Optimizer>(); })));
+    CHECK(same_parameters(
+        train(small, inputs, targets, [] { return std::unique_ptr<Optimizer>(new AdamW(0.9f, 0.999f, 1e-8f, 0.0f)); }),
+        train(small, inputs, targets, [] { return std::unique_ptr<Optimizer>(new Adam()); })));
+
+    const std::vector<size_t> sizes = {64, 300, 300, 16};
+    check::threads_agree("training, momentum", [&] {
+        return train(sizes, inputs, targets, [] { return std::unique_ptr<Optimizer>(new SGD(0.9f, true)); });
+    });
+    check::threads_agree("training, adamw", [&] {
+        return train(sizes, inputs, targets, [] { return std::unique_ptr<Optimizer>(new AdamW()); });
+    });
+    return check::result("optimizer_test");
+}
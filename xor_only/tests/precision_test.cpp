@@ -0,0 +1,64 @@
+#include "BenchUtil.h"
+#include "Check.h"
+#include <vector>
+
+// Checks that the bfloat16 and float16 conversion kernels of each supported
+// instruction set return the same bits as the scalar table, including the
+// rounding of halfway cases, and that 16-bit tensor operations do with one
+// thread and with several.
+
+using namespace nn;
+using namespace nn::kernels;
+
+namespace {
+
+using check::add_special_values;
+using check::N;
+using check::OFFSET;
+using check::random_floats;
+
+void check_conversions(const ConversionKernels& k, const ConversionKernels& ref) {
+    std::vector<float> x = random_floats(N, -70000.0f, 70000.0f);
+    add_special_values(x);
+    // Halfway cases of both 16-bit formats and values around their limits
+    x[OFFSET + 1] = 1.0f + 1.0f / 256.0f;
+    x[OFFSET + 2] = 1.0f + 3.0f / 2048.0f;
+    x[OFFSET + 4] = 65520.0f;
+    x[OFFSET + 5] = 6e-8f;
+    std::vector<uint16_t> h(N), expected_h(N);
+    std::vector<float> out(N), expected(N);
+
+    k.float_to_bf16(x.data() + OFFSET, h.data(), N);
+    ref.float_to_bf16(x.data() + OFFSET, expected_h.data(), N);
+    CHECK(check::same_bits(h.data(), expected_h.data(), N));
+    k.bf16_to_float(h.data(), out.data(), N);
+    ref.bf16_to_float(h.data(), expected.data(), N);
+    CHECK(check::same_bits(out.data(), expected.data(), N));
+
+    k.float_to_fp16(x.data() + OFFSET, h.data(), N);
+    ref.float_to_fp16(x.data() + OFFSET, expected_h.data(), N);
+    CHECK(check::same_bits(h.data(), expected_h.data(), N));
+    k.fp16_to_float(h.data(), out.data(), N);
+    ref.fp16_to_float(h.data(), expected.data(), N);
+    CHECK(check::same_bits(out.data(), expected.data(), N));
+}
+
+} // namespace
+
+int main() {
+    check::for_each_isa([](Isa isa) { check_conversions(conversions(isa), conversions(Isa::Scalar)); });
+
+    std::mt19937 gen(99);
+    const Tensor a = bench::random_tensor(300, 500, gen);
+    const Tensor b = bench::random_tensor(500, 200, gen);
+    const Tensor c = bench::random_tensor(300, 500, gen);
+    check::threads_agree("16-bit storage", [&] {
+        Tensor half;
+        convert_into(half, a, DType::Float16);
+        Tensor product;
+        matmul_into(product, half, b);
+        half.axpy_(-0.5f, c);
+        return std::vector<Tensor>{half, product};
+    });
+    return check::result("precision_test");
+}
@@ -0,0 +1,59 @@
+#include "BenchUtil.h"
+#include "Check.h"
+#include <vector>
+
+// Checks that the int8 tile and quantize kernels of each supported
+// instruction set return the same bits as the scalar table, and that a
+// quantized network predicts the same bits with one thread and with
+// several.
+
+using namespace nn;
+using namespace nn::kernels;
+
+namespace {
+
+using check::add_special_values;
+using check::N;
+using check::OFFSET;
+using check::random_floats;
+
+void check_quantized(const QuantizedKernels& k, const QuantizedKernels& ref) {
+    const size_t quads = 37;
+    std::uniform_int_distribution<int> weight(-127, 127), activation(0, 127);
+    std::vector<int8_t> a(quads * QUANT_TILE_ROWS * 4);
+    std::vector<uint8_t> b(quads * QUANT_TILE_COLS * 4);
+    for (auto& w : a) {
+        w = static_cast<int8_t>(weight(check::generator()));
+    }
+    for (auto& x : b) {
+        x = static_cast<uint8_t>(activation(check::generator()));
+    }
+    int32_t c[QUANT_TILE_ROWS * QUANT_TILE_COLS], expected_c[QUANT_TILE_ROWS * QUANT_TILE_COLS];
+    k.tile(quads, a.data(), b.data(), c);
+    ref.tile(quads, a.data(), b.data(), expected_c);
+    CHECK(check::same_bits(c, expected_c, QUANT_TILE_ROWS * QUANT_TILE_COLS));
+
+    std::vector<float> x = random_floats(N, -3.0f, 3.0f);
+    add_special_values(x);
+    std::vector<uint8_t> q(N), expected_q(N);
+    k.quantize(x.data() + OFFSET, q.data(), N, 21.0f, 63.5f);
+    ref.quantize(x.data() + OFFSET, expected_q.data(), N, 21.0f, 63.5f);
+    CHECK(check::same_bits(q.data(), expected_q.data(), N));
+}
+
+} // namespace
+
+int main() {
+    check::for_each_isa([](Isa isa) { check_quantized(quantized(isa), quantized(Isa::Scalar)); });
+
+    std::mt19937 gen(99);
+    const Tensor inputs = bench::random_tensor(500, 200, gen);
+    check::threads_agree("quantized forward", [&] {
+        Network net;
+        std::mt19937 weight_gen(11);
+        bench::build(net, {500, 256, 64}, weight_gen, true);
+        net.quantize(inputs);
+        return std::vector<Tensor>{net.predict(inputs)};
+    });
+    return check::result("quantize_test");
+}
@@ -0,0 +1,46 @@
+#include "BenchUtil.h"
+#include "Check.h"
+#include <limits>
+#include <vector>
+
+// Checks that the sum and max kernels of each supported instruction set
+// return the same bits as the scalar table, and that tensor reductions do
+// with one thread and with several: partial results are combined in a
+// fixed tree whatever the thread count.
+
+using namespace nn;
+using namespace nn::kernels;
+
+namespace {
+
+using check::N;
+using check::OFFSET;
+using check::random_floats;
+
+void check_reductions(const ReductionKernels& k, const ReductionKernels& ref) {
+    for (size_t n : {size_t(0), size_t(1), size_t(7), size_t(64), N, size_t(100000)}) {
+        std::vector<float> x = random_floats(n, -1.0f, 1.0f);
+        const float sum = k.sum(x.data() + OFFSET, n);
+        const float expected_sum = ref.sum(x.data() + OFFSET, n);
+        CHECK(check::same_bits(&sum, &expected_sum, 1));
+        if (n > 100) {
+            x[OFFSET + 50] = std::numeric_limits<float>::quiet_NaN();
+        }
+        const float max = k.max(x.data() + OFFSET, n);
+        const float expected_max = ref.max(x.data() + OFFSET, n);
+        CHECK(check::same_bits(&max, &expected_max, 1));
+    }
+}
+
+} // namespace
+
+int main() {
+    check::for_each_isa([](Isa isa) { check_reductions(reductions(isa), reductions(Isa::Scalar)); });
+
+    std::mt19937 gen(99);
+    const Tensor a = bench::random_tensor(300, 500, gen);
+    check::threads_agree("reductions", [&] {
+        return std::vector<Tensor>{a.sum(), a.sum(0), a.sum(1), a.mean(1), a.max(0), a.argmax(1)};
+    });
+    return check::result("reduction_test");
+}
@@ -0,0 +1,51 @@
+#include "BenchUtil.h"
+#include "Check.h"
+#include <vector>
+
+// Checks that the CSR and blocked sparse kernels of each supported
+// instruction set return the same bits as the scalar table, and that the
+// sparse-dense product of a pruned layer does with one thread and with
+// several.
+
+using namespace nn;
+using namespace nn::kernels;
+
+namespace {
+
+using check::random_floats;
+
+void check_sparse(const SparseKernels& k, const SparseKernels& ref) {
+    const size_t rows = 53, n = 131, blocks = 19;
+    std::vector<float> x = random_floats(rows * n, -1.0f, 1.0f);
+    std::vector<float> values = random_floats(blocks * SPARSE_BLOCK_ROWS, -1.0f, 1.0f);
+    std::vector<uint32_t> cols(blocks);
+    for (size_t p = 0; p < blocks; ++p) {
+        cols[p] = static_cast<uint32_t>(p * 2 + p % 3);
+    }
+    std::vector<float> out(SPARSE_BLOCK_ROWS * n), expected(SPARSE_BLOCK_ROWS * n);
+    k.csr(blocks, cols.data(), values.data(), x.data(), n, out.data(), n, n);
+    ref.csr(blocks, cols.data(), values.data(), x.data(), n, expected.data(), n, n);
+    CHECK(check::same_bits(out.data(), expected.data(), n));
+    k.blocked(blocks, cols.data(), values.data(), x.data(), n, out.data(), n, n);
+    ref.blocked(blocks, cols.data(), values.data(), x.data(), n, expected.data(), n, n);
+    CHECK(check::same_bits(out.data(), expected.data(), SPARSE_BLOCK_ROWS * n));
+}
+
+} // namespace
+
+int main() {
+    check::for_each_isa([](Isa isa) { check_sparse(sparse(isa), sparse(Isa::Scalar)); });
+
+    std::mt19937 gen(99);
+    const Tensor inputs = bench::random_tensor(500, 200, gen);
+    Network net;
+    bench::build(net, {500, 400}, gen, true);
+    auto* layer = static_cast<Linear*>(net.get_layers()[0]);
+    layer->prune(0.9f, SparseFormat::Blocked);
+    check::threads_agree("sparse matmul", [&] {
+        Tensor out;
+        sparse_matmul_into(out, layer->get_sparse_weights(), inputs);
+        return std::vector<Tensor>{out};
+    });
+    return check::result("sparse_test");
+}
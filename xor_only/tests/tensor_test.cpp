@@ -0,0 +1,94 @@
+#include "Arena.h"
+#include "Check.h"
+#include "Tensor.h"
+#include <vector>
+
+// Regression checks for Tensor and Storage semantics
+
+using namespace nn;
+
+using Rows = std::vector<std::vector<float>>;
+
+namespace {
+
+// A tensor move-constructed inside an ArenaScope into a longer-lived
+// container must not keep pointing into the arena
+void check_move_out_of_arena() {
+    Tensor a(1, 4);
+    a.fill(1.0f);
+    std::vector<Tensor> kept;
+    {
+        ArenaScope scope;
+        kept.push_back(a.sigmoid());
+    }
+    {
+        // Reuses the arena memory the first result was computed in
+        ArenaScope scope;
+        Tensor overwrite = a * 100.0f;
+    }
+    CHECK(kept[0][0] > 0.73f && kept[0][0] < 0.74f);
+    CHECK(kept[0].allocator() == default_allocator());
+
+    // Moving external memory keeps pointing at it
+    float memory[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    Tensor external = Tensor::from_external(memory, Shape{4});
+    Tensor moved(std::move(external));
+    moved[0] = 5.0f;
+    CHECK(memory[0] == 5.0f);
+}
+
+// Expressions over views pack them instead of throwing
+void check_view_expressions() {
+    Tensor a(Rows{{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}});
+    Tensor sum;
+    CHECK_NO_THROW(sum = a.slice(1, 0, 2) + a.slice(1, 1, 3));
+    CHECK(sum.shape() == Shape({2, 2}));
+    CHECK(sum.at({0, 0}) == 3.0f && sum.at({0, 1}) == 5.0f);
+    CHECK(sum.at({1, 0}) == 9.0f && sum.at({1, 1}) == 11.0f);
+
+    // A transposed view, with a scalar and broadcast against a row
+    Tensor t = a.transpose() * 2.0f;
+    CHECK(t.shape() == Shape({3, 2}) && t.at({2, 1}) == 12.0f);
+    Tensor row(Rows{{10.0f, 20.0f}});
+    Tensor shifted = a.transpose() + row;
+    CHECK(shifted.at({0, 0}) == 11.0f && shifted.at({2, 1}) == 26.0f);
+}
+
+// Expressions widen 16-bit operands instead of throwing
+void check_half_expressions() {
+    Tensor a(Rows{{1.0f, 2.0f}, {3.0f, 4.0f}});
+    for (DType dtype : {DType::BFloat16, DType::Float16}) {
+        Tensor h = a.to(dtype);
+        Tensor scaled, doubled, mixed;
+        CHECK_NO_THROW(scaled = h * 2.0f);
+        CHECK_NO_THROW(doubled = h + h);
+        CHECK_NO_THROW(mixed = a - h.transpose());
+        CHECK(scaled.dtype() == DType::Float32 && scaled.at({1, 1}) == 8.0f);
+        CHECK(doubled.at({0, 1}) == 4.0f);
+        CHECK(mixed.at({0, 1}) == -1.0f && mixed.at({1, 0}) == 1.0f);
+    }
+}
+
+// A product over an empty inner dimension is all zeros
+void check_empty_inner_product() {
+    Tensor a(3, 0);
+    Tensor b(0, 4);
+    Tensor c;
+    CHECK_NO_THROW(c = a.matmul(b));
+    CHECK(c.shape() == Shape({3, 4}));
+    bool zeros = true;
+    for (size_t i = 0; i < c.size(); ++i) {
+        zeros = zeros && c[i] == 0.0f;
+    }
+    CHECK(zeros);
+}
+
+} // namespace
+
+int main() {
+    check_move_out_of_arena();
+    check_view_expressions();
+    check_half_expressions();
+    check_empty_inner_product();
+    return check::result("tensor_test");
+}
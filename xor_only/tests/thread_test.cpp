@@ -0,0 +1,35 @@
+#include "BenchUtil.h"
+#include "Check.h"
+#include <random>
+#include <vector>
+
+// Runs the parallel matmul and element-wise operations with one thread and
+// with several, and checks that the results are the same bits: each output
+// element is computed by one task in a fixed order. The per-feature tests
+// check their own operations the same way.
+
+using namespace nn;
+using bench::random_tensor;
+
+int main() {
+    std::mt19937 gen(99);
+    const Tensor a = random_tensor(300, 500, gen);
+    const Tensor b = random_tensor(500, 200, gen);
+    const Tensor c = random_tensor(300, 500, gen);
+    const Tensor bias = random_tensor(300, 1, gen);
+
+    check::threads_agree("matmul", [&] { return std::vector<Tensor>{a.matmul(b)}; });
+    check::threads_agree("matmul transposed", [&] {
+        Tensor out;
+        matmul_into(out, b, a, Transpose::Yes, Transpose::Yes);
+        return std::vector<Tensor>{out};
+    });
+    check::threads_agree("element-wise", [&] {
+        Tensor expr = a * c + a - c * 0.5f;
+        Tensor in_place = a;
+        in_place.axpy_(0.25f, c);
+        in_place.add_(bias);
+        return std::vector<Tensor>{expr, in_place, a.relu()};
+    });
+    return check::result("thread_test");
+}
@@ -0,0 +1,69 @@
+#include "BenchUtil.h"
+#include "Check.h"
+#include "Trainer.h"
+#include <algorithm>
+#include <vector>
+
+// Checks that an epoch of Trainer is the same train_step sequence over
+// column slices of the dataset, and that shuffled mini-batch training
+// leaves the same parameters with one thread and with several.
+
+using namespace nn;
+
+namespace {
+
+const std::vector<size_t> SIZES = {64, 48, 16};
+
+void build(Network& net) {
+    std::mt19937 gen(3);
+    bench::build(net, SIZES, gen, true);
+}
+
+void check_batches(const Tensor& inputs, const Tensor& targets, size_t batch_size) {
+    Network trained, stepped;
+    build(trained);
+    build(stepped);
+    MSELoss loss;
+    Trainer trainer(trained, batch_size);
+    trainer.train_epoch(inputs, targets, loss, 0.1f);
+    for (size_t first = 0; first < inputs.shape()[1]; first += batch_size) {
+        const size_t last = std::min(first + batch_size, inputs.shape()[1]);
+        stepped.train_step(inputs.slice(1, first, last).contiguous(), targets.slice(1, first, last).contiguous(),
+                           loss, 0.1f);
+    }
+    const std::vector<Tensor> a = check::parameters(trained);
+    const std::vector<Tensor> b = check::parameters(stepped);
+    CHECK(a.size() == b.size());
+    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+        CHECK(check::same_bits(a[i].data(), b[i].data(), a[i].size()));
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 gen(99);
+    const Tensor inputs = bench::random_tensor(64, 100, gen);
+    const Tensor targets = bench::random_tensor(16, 100, gen, 0.5f);
+
+    // Whole dataset, even batches and a short last batch
+    for (size_t batch_size : {size_t(100), size_t(25), size_t(32)}) {
+        check_batches(inputs, targets, batch_size);
+    }
+
+    const Tensor large_inputs = bench::random_tensor(64, 512, gen);
+    const Tensor large_targets = bench::random_tensor(16, 512, gen, 0.5f);
+    check::threads_agree("training, layer updates", [&] {
+        Network net;
+        std::mt19937 weight_gen(3);
+        bench::build(net, {64, 300, 300, 16}, weight_gen, true);
+        Trainer trainer(net, 128);
+        trainer.set_shuffle(true, 5);
+        MSELoss loss;
+        for (int epoch = 0; epoch < 3; ++epoch) {
+            trainer.train_epoch(large_inputs, large_targets, loss, 0.05f);
+        }
+        return check::parameters(net);
+    });
+    return check::result("trainer_test");
+}